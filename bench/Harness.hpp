@@ -0,0 +1,131 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <utility>
+
+#include "PerfCounters.hpp"
+
+namespace bench
+{
+
+    /**
+     * @brief One measured scenario.
+     */
+    struct Result
+    {
+        std::string structure; // "MyContainer", "std::multiset" or "sorted_vector".
+        std::string operation; // e.g. "construct", "traverse_cold", "remove".
+        std::string order;     // Iteration order, or "" when not applicable.
+        size_t size = 0;       // Number of elements in the container.
+        size_t reps = 0;       // Repetitions averaged.
+        double ns = 0;         // Mean wall-clock nanoseconds per repetition.
+        size_t ops = 0;        // Operations (elements visited, inserts, ...) per repetition.
+        Counts counters;       // Hardware counters per repetition (only with --perf).
+    };
+
+    /**
+     * @brief Monotonic nanosecond stopwatch.
+     */
+    class Timer
+    {
+    private:
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    public:
+        /**
+         * @brief Nanoseconds since construction.
+         */
+        double elapsed_ns() const
+        {
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    /**
+     * @brief Keeps a computed value alive so the optimizer cannot drop the work producing it.
+     */
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * @brief Runs fn `reps` times (after setup each time, untimed) and returns the mean time of fn.
+     *
+     * @param reps Number of repetitions.
+     * @param setup Untimed preparation invoked before every repetition.
+     * @param fn The measured work.
+     * @param perf If set, counts hardware events around each fn call (collect them with perf->take(reps)).
+     * @return double Mean nanoseconds per repetition.
+     */
+    template <typename Setup, typename Fn>
+    double measure(size_t reps, Setup setup, Fn fn, PerfCounters *perf = nullptr)
+    {
+        double total = 0;
+        for (size_t r = 0; r < reps; ++r)
+        {
+            setup();
+            if (perf)
+                perf->start();
+            Timer timer;
+            fn();
+            total += timer.elapsed_ns();
+            if (perf)
+                perf->stop();
+        }
+        return total / static_cast<double>(reps);
+    }
+
+    /**
+     * @brief Escapes a string for a JSON literal.
+     */
+    inline std::string json_escape(const std::string &s)
+    {
+        std::string out;
+        for (char ch : s)
+        {
+            if (ch == '"' || ch == '\\')
+                out += '\\';
+            out += ch;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Writes the available counters as extra JSON members.
+     */
+    inline void write_counters(std::ostream &os, const Counts &c)
+    {
+        const std::pair<const char *, int64_t> fields[] = {
+            {"cycles", c.cycles}, {"instructions", c.instructions}, {"l1d_misses", c.l1d_misses},
+            {"llc_misses", c.llc_misses}, {"branch_misses", c.branch_misses}};
+        for (const auto &f : fields)
+            if (f.second >= 0)
+                os << ", \"" << f.first << "\": " << f.second;
+    }
+
+    /**
+     * @brief Writes results as a JSON array of objects; counters appear only when they were measured.
+     */
+    inline void write_json(std::ostream &os, const std::vector<Result> &results)
+    {
+        os << "[\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            os << "  {\"structure\": \"" << json_escape(r.structure) << "\", \"operation\": \"" << json_escape(r.operation)
+               << "\", \"order\": \"" << json_escape(r.order) << "\", \"size\": " << r.size << ", \"reps\": " << r.reps
+               << ", \"ns\": " << static_cast<uint64_t>(r.ns) << ", \"ns_per_op\": "
+               << (r.ops ? r.ns / static_cast<double>(r.ops) : 0.0);
+            write_counters(os, r.counters);
+            os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        os << "]\n";
+    }
+
+}
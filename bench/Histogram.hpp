@@ -0,0 +1,133 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace bench
+{
+
+    /**
+     * @brief HDR-style latency histogram with logarithmic buckets.
+     *
+     * Values below 2^SUB_BITS are counted exactly. Above that, each power of two is split into
+     * 2^SUB_BITS linear sub-buckets, so every recorded value is resolved to within about 3%
+     * regardless of magnitude, in a fixed 15 KiB table and O(1) time per record.
+     */
+    class Histogram
+    {
+    private:
+        static constexpr unsigned SUB_BITS = 5;                 // log2 of sub-buckets per power of two.
+        static constexpr uint64_t SUB_COUNT = 1ULL << SUB_BITS; // Sub-buckets per power of two.
+        static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+        std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS); // Samples per bucket.
+        uint64_t total = 0;                                            // Number of samples.
+        uint64_t lowest = UINT64_MAX;                                  // Smallest sample.
+        uint64_t highest = 0;                                          // Largest sample.
+        double sum = 0;                                                // Sum of samples, for the mean.
+
+        static unsigned log2_floor(uint64_t v)
+        {
+            return 63 - static_cast<unsigned>(__builtin_clzll(v));
+        }
+
+        /**
+         * @brief Returns the bucket of a value.
+         */
+        static size_t bucket_of(uint64_t v)
+        {
+            if (v < SUB_COUNT)
+                return static_cast<size_t>(v);
+            unsigned e = log2_floor(v);
+            uint64_t sub = (v >> (e - SUB_BITS)) & (SUB_COUNT - 1);
+            return static_cast<size_t>((e - SUB_BITS + 1) * SUB_COUNT + sub);
+        }
+
+        /**
+         * @brief Returns the largest value that falls into bucket b.
+         */
+        static uint64_t bucket_high(size_t b)
+        {
+            if (b < SUB_COUNT)
+                return b;
+            unsigned e = static_cast<unsigned>(b / SUB_COUNT) + SUB_BITS - 1;
+            uint64_t sub = b % SUB_COUNT;
+            uint64_t width = 1ULL << (e - SUB_BITS);
+            return ((SUB_COUNT + sub) << (e - SUB_BITS)) + (width - 1);
+        }
+
+    public:
+        /**
+         * @brief Records one sample.
+         *
+         * @param ns Latency in nanoseconds.
+         */
+        void record(uint64_t ns)
+        {
+            ++counts[bucket_of(ns)];
+            ++total;
+            lowest = std::min(lowest, ns);
+            highest = std::max(highest, ns);
+            sum += static_cast<double>(ns);
+        }
+
+        /**
+         * @brief Returns the number of samples.
+         */
+        uint64_t count() const
+        {
+            return total;
+        }
+
+        /**
+         * @brief Returns the smallest sample (0 when empty).
+         */
+        uint64_t min() const
+        {
+            return total ? lowest : 0;
+        }
+
+        /**
+         * @brief Returns the largest sample.
+         */
+        uint64_t max() const
+        {
+            return highest;
+        }
+
+        /**
+         * @brief Returns the mean sample (0 when empty).
+         */
+        double mean() const
+        {
+            return total ? sum / static_cast<double>(total) : 0.0;
+        }
+
+        /**
+         * @brief Returns the value at or below which `p` percent of the samples lie.
+         *
+         * The answer is the upper edge of the bucket holding that sample, clamped to max(), so it
+         * never understates a tail.
+         *
+         * @param p Percentile in [0, 100], e.g. 99.9.
+         * @return uint64_t Nanoseconds (0 when empty).
+         */
+        uint64_t percentile(double p) const
+        {
+            if (total == 0)
+                return 0;
+            uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+            rank = std::min(std::max<uint64_t>(rank, 1), total);
+            uint64_t seen = 0;
+            for (size_t b = 0; b < BUCKETS; ++b)
+            {
+                seen += counts[b];
+                if (seen >= rank)
+                    return std::min(bucket_high(b), highest);
+            }
+            return highest;
+        }
+    };
+
+}
@@ -0,0 +1,159 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace bench
+{
+
+    /**
+     * @brief Hardware counter readings averaged per repetition; -1 marks an unavailable counter.
+     */
+    struct Counts
+    {
+        int64_t cycles = -1;        // CPU cycles.
+        int64_t instructions = -1;  // Retired instructions.
+        int64_t l1d_misses = -1;    // L1 data cache read misses.
+        int64_t llc_misses = -1;    // Last-level cache misses.
+        int64_t branch_misses = -1; // Mispredicted branches.
+    };
+
+    /**
+     * @brief User-space hardware counters read with perf_event_open around measured regions.
+     *
+     * Each counter is opened on its own, so a PMU lacking one event (common in VMs) still
+     * reports the others. Counters that cannot be opened, e.g. because of
+     * /proc/sys/kernel/perf_event_paranoid or a missing PMU, stay at -1; the benchmark then
+     * degrades to wall-clock numbers only. Readings are scaled when the kernel multiplexes events.
+     */
+    class PerfCounters
+    {
+    private:
+        static constexpr size_t EVENTS = 5;
+
+        int fds[EVENTS] = {-1, -1, -1, -1, -1}; // One descriptor per counter, -1 if unavailable.
+        double totals[EVENTS] = {};             // Sums accumulated by stop() since the last take().
+
+#ifdef __linux__
+        static int open_event(uint32_t type, uint64_t config)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+
+    public:
+        /**
+         * @brief Opens every counter that the kernel and PMU allow.
+         */
+        PerfCounters()
+        {
+#ifdef __linux__
+            const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            fds[0] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            fds[1] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            fds[2] = open_event(PERF_TYPE_HW_CACHE, l1d_read_miss);
+            fds[3] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+            fds[4] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+        }
+
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        /**
+         * @brief Closes the counters.
+         */
+        ~PerfCounters()
+        {
+#ifdef __linux__
+            for (int fd : fds)
+                if (fd >= 0)
+                    ::close(fd);
+#endif
+        }
+
+        /**
+         * @brief Returns true if at least one counter could be opened.
+         */
+        bool available() const
+        {
+            for (int fd : fds)
+                if (fd >= 0)
+                    return true;
+            return false;
+        }
+
+        /**
+         * @brief Resets and enables the counters at the start of a measured region.
+         */
+        void start()
+        {
+#ifdef __linux__
+            for (int fd : fds)
+                if (fd >= 0)
+                {
+                    ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+#endif
+        }
+
+        /**
+         * @brief Disables the counters and adds the region's counts to the running totals.
+         */
+        void stop()
+        {
+#ifdef __linux__
+            for (int fd : fds)
+                if (fd >= 0)
+                    ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            for (size_t i = 0; i < EVENTS; ++i)
+            {
+                uint64_t reading[3]; // value, time enabled, time running
+                if (fds[i] < 0 || ::read(fds[i], reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading)))
+                    continue;
+                double value = static_cast<double>(reading[0]);
+                if (reading[2] != 0 && reading[2] < reading[1])
+                    value *= static_cast<double>(reading[1]) / static_cast<double>(reading[2]);
+                totals[i] += value;
+            }
+#endif
+        }
+
+        /**
+         * @brief Returns the totals averaged over reps regions and clears them.
+         *
+         * @param reps Number of start()/stop() regions since the previous take().
+         * @return Counts Per-repetition counts, -1 for unavailable counters.
+         */
+        Counts take(size_t reps)
+        {
+            int64_t mean[EVENTS];
+            for (size_t i = 0; i < EVENTS; ++i)
+            {
+                mean[i] = fds[i] >= 0 && reps > 0 ? static_cast<int64_t>(totals[i] / static_cast<double>(reps)) : -1;
+                totals[i] = 0;
+            }
+            return Counts{mean[0], mean[1], mean[2], mean[3], mean[4]};
+        }
+    };
+
+}
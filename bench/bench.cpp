@@ -0,0 +1,440 @@
+// Author : noapatito123@gmail.com
+#include "MyContainer.hpp"
+#include "Workloads.hpp"
+#include "Harness.hpp"
+#include "Histogram.hpp"
+
+#include <set>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace containers;
+
+namespace
+{
+
+    /**
+     * @brief Command-line options of the benchmark runner.
+     */
+    struct Options
+    {
+        size_t min_size = 10;      // Smallest container size.
+        size_t max_size = 1000000; // Largest container size (sizes grow by 10x).
+        std::string out;           // JSON output file; stdout when empty.
+        workloads::Distribution distribution = workloads::Distribution::Uniform; // Shape of the inserted values.
+        uint64_t seed = 1;         // Workload generator seed.
+        bool latency = false;      // Record per-operation latency histograms instead of mean times.
+        bool perf = false;         // Read hardware performance counters around each measured region.
+    };
+
+    const std::pair<Order, const char *> ORDERS[] = {
+        {Order::Ascending, "Ascending"},
+        {Order::Descending, "Descending"},
+        {Order::SideCross, "SideCross"},
+        {Order::Reverse, "Reverse"},
+        {Order::Regular, "Regular"},
+        {Order::MiddleOut, "MiddleOut"}};
+
+    bench::PerfCounters *perf = nullptr; // Hardware counters, set by --perf.
+
+    /**
+     * @brief Appends a result, attaching the counters collected by its measure() call.
+     */
+    void add_result(std::vector<bench::Result> &results, bench::Result r)
+    {
+        if (perf)
+            r.counters = perf->take(r.reps);
+        results.push_back(r);
+    }
+
+    /**
+     * @brief Fewer repetitions for larger sizes so every scenario takes roughly the same time.
+     */
+    size_t reps_for(size_t n)
+    {
+        return std::max<size_t>(1, std::min<size_t>(50, 1000000 / n));
+    }
+
+    /**
+     * @brief Traverses one order with a range-for and returns a checksum of the visited values.
+     */
+    long long traverse(const MyContainer<int> &c, Order order)
+    {
+        long long sum = 0;
+        switch (order)
+        {
+        case Order::Ascending:
+            for (int v : c.Ascending())
+                sum += v;
+            break;
+        case Order::Descending:
+            for (int v : c.Descending())
+                sum += v;
+            break;
+        case Order::SideCross:
+            for (int v : c.SideCross())
+                sum += v;
+            break;
+        case Order::Reverse:
+            for (int v : c.Reverse())
+                sum += v;
+            break;
+        case Order::Regular:
+            for (int v : c.Regular())
+                sum += v;
+            break;
+        case Order::MiddleOut:
+            for (int v : c.MiddleOut())
+                sum += v;
+            break;
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Constructs the begin iterator of one order (building its permutation) and returns its element.
+     *
+     * The container must not be empty.
+     */
+    int construct_begin(const MyContainer<int> &c, Order order)
+    {
+        switch (order)
+        {
+        case Order::Ascending:
+            return *c.Ascending().begin();
+        case Order::Descending:
+            return *c.Descending().begin();
+        case Order::SideCross:
+            return *c.SideCross().begin();
+        case Order::Reverse:
+            return *c.Reverse().begin();
+        case Order::Regular:
+            return *c.Regular().begin();
+        case Order::MiddleOut:
+            return *c.MiddleOut().begin();
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Measures MyContainer construction, traversal of every order, add and remove at size n.
+     */
+    void bench_container(size_t n, const std::vector<int> &values, std::vector<bench::Result> &results)
+    {
+        size_t reps = reps_for(n);
+        MyContainer<int> c;
+
+        double ns = bench::measure(reps, [&]()
+                                   { c = MyContainer<int>(); },
+                                   [&]()
+                                   {
+                                       for (int v : values)
+                                           c.add(v);
+                                   }, perf);
+        add_result(results, {"MyContainer", "construct", "", n, reps, ns, n, {}});
+
+        for (const auto &order : ORDERS)
+        {
+            MyContainer<int> fresh;
+            ns = bench::measure(reps, [&]()
+                                {
+                                    fresh = MyContainer<int>();
+                                    fresh.add_all(values.begin(), values.end());
+                                },
+                                [&]()
+                                { bench::do_not_optimize(traverse(fresh, order.first)); }, perf);
+            add_result(results, {"MyContainer", "traverse_cold", order.second, n, reps, ns, n, {}});
+
+            ns = bench::measure(reps, []() {}, [&]()
+                                { bench::do_not_optimize(traverse(fresh, order.first)); }, perf);
+            add_result(results, {"MyContainer", "traverse_warm", order.second, n, reps, ns, n, {}});
+        }
+
+        const size_t batch = std::min<size_t>(n, 100);
+        ns = bench::measure(reps, []() {}, [&]()
+                            {
+                                for (size_t i = 0; i < batch; ++i)
+                                    c.add(values[i]);
+                            }, perf);
+        add_result(results, {"MyContainer", "add", "", n, reps, ns, batch, {}});
+
+        std::vector<int> victims(values.begin(), values.begin() + batch);
+        std::sort(victims.begin(), victims.end());
+        victims.erase(std::unique(victims.begin(), victims.end()), victims.end());
+        ns = bench::measure(reps, [&]()
+                            {
+                                c = MyContainer<int>();
+                                c.add_all(values.begin(), values.end());
+                            },
+                            [&]()
+                            {
+                                for (int v : victims)
+                                    c.remove(v);
+                            }, perf);
+        add_result(results, {"MyContainer", "remove", "", n, reps, ns, victims.size(), {}});
+
+        const size_t probes = std::min<size_t>(n, 1000);
+        for (const char *variant : {"binary_search", "eytzinger", "learned"})
+        {
+            MyContainer<int> searched;
+            searched.add_all(values.begin(), values.end());
+            if (std::string(variant) == "eytzinger")
+                searched.use_search_index();
+            else if (std::string(variant) == "learned")
+                searched.use_learned_index();
+            searched.sorted_indices();
+            bench::do_not_optimize(*searched.Ascending().lower_bound(values[0])); // builds the index
+            ns = bench::measure(reps, []() {}, [&]()
+                                {
+                                    size_t total = 0;
+                                    for (size_t i = 0; i < probes; ++i)
+                                        total += searched.rank(values[(i * 7919) % n]);
+                                    bench::do_not_optimize(total);
+                                }, perf);
+            add_result(results, {"MyContainer", "rank", variant, n, reps, ns, probes, {}});
+        }
+    }
+
+    /**
+     * @brief Measures the std::multiset and sorted-vector baselines at size n.
+     */
+    void bench_baselines(size_t n, const std::vector<int> &values, std::vector<bench::Result> &results)
+    {
+        size_t reps = reps_for(n);
+        std::multiset<int> set;
+        double ns = bench::measure(reps, [&]()
+                                   { set.clear(); },
+                                   [&]()
+                                   { set.insert(values.begin(), values.end()); }, perf);
+        add_result(results, {"std::multiset", "construct", "", n, reps, ns, n, {}});
+        ns = bench::measure(reps, []() {}, [&]()
+                            {
+                                long long sum = 0;
+                                for (int v : set)
+                                    sum += v;
+                                bench::do_not_optimize(sum);
+                            }, perf);
+        add_result(results, {"std::multiset", "traverse_warm", "Ascending", n, reps, ns, n, {}});
+
+        std::vector<int> sorted;
+        ns = bench::measure(reps, [&]()
+                            { sorted.clear(); },
+                            [&]()
+                            {
+                                sorted.assign(values.begin(), values.end());
+                                std::sort(sorted.begin(), sorted.end());
+                            }, perf);
+        add_result(results, {"sorted_vector", "construct", "", n, reps, ns, n, {}});
+        ns = bench::measure(reps, []() {}, [&]()
+                            {
+                                long long sum = 0;
+                                for (int v : sorted)
+                                    sum += v;
+                                bench::do_not_optimize(sum);
+                            }, perf);
+        add_result(results, {"sorted_vector", "traverse_warm", "Ascending", n, reps, ns, n, {}});
+    }
+
+    /**
+     * @brief One latency histogram row of the report.
+     */
+    struct LatencyRow
+    {
+        std::string operation; // e.g. "add", "remove", "begin".
+        std::string order;     // Iteration order, or "" when not applicable.
+        bench::Histogram histogram;
+    };
+
+    /**
+     * @brief Grows one container from empty to max_size, timing every add individually.
+     *
+     * About 1000 times along the way (at evenly spaced sizes) it also times removing the value
+     * just added, which removes every equal element, then re-adds as many copies as were removed
+     * (untimed) so the container keeps growing on duplicate-heavy distributions too. Finally it
+     * times constructing the begin iterator of every order right after that mutation, i.e. with
+     * the sorted permutation invalidated.
+     */
+    std::vector<LatencyRow> bench_latency(const std::vector<int> &values)
+    {
+        std::vector<LatencyRow> rows;
+        rows.push_back({"add", "", {}});
+        rows.push_back({"remove", "", {}});
+        for (const auto &order : ORDERS)
+            rows.push_back({"begin", order.second, {}});
+
+        const size_t probe_every = std::max<size_t>(1, values.size() / 1000);
+        MyContainer<int> c;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            bench::Timer add_timer;
+            c.add(values[i]);
+            rows[0].histogram.record(static_cast<uint64_t>(add_timer.elapsed_ns()));
+
+            if ((i + 1) % probe_every != 0)
+                continue;
+            const size_t before = c.size();
+            bench::Timer remove_timer;
+            c.remove(values[i]);
+            rows[1].histogram.record(static_cast<uint64_t>(remove_timer.elapsed_ns()));
+            for (size_t copies = before - c.size(); copies > 0; --copies)
+                c.add(values[i]);
+            for (size_t o = 0; o < std::size(ORDERS); ++o)
+            {
+                bench::Timer begin_timer;
+                bench::do_not_optimize(construct_begin(c, ORDERS[o].first));
+                rows[2 + o].histogram.record(static_cast<uint64_t>(begin_timer.elapsed_ns()));
+            }
+        }
+        return rows;
+    }
+
+    const std::pair<double, const char *> PERCENTILES[] = {
+        {50, "p50"}, {90, "p90"}, {99, "p99"}, {99.9, "p99.9"}, {99.99, "p99.99"}};
+
+    /**
+     * @brief Prints the latency rows as a fixed-width table of nanosecond percentiles.
+     */
+    void print_latency(std::ostream &os, const std::vector<LatencyRow> &rows)
+    {
+        os << std::left << std::setw(8) << "op" << std::setw(12) << "order" << std::right << std::setw(10) << "count"
+           << std::setw(10) << "mean";
+        for (const auto &p : PERCENTILES)
+            os << std::setw(12) << p.second;
+        os << std::setw(12) << "max" << "\n";
+        for (const auto &row : rows)
+        {
+            const bench::Histogram &h = row.histogram;
+            os << std::left << std::setw(8) << row.operation << std::setw(12) << row.order << std::right << std::setw(10)
+               << h.count() << std::setw(10) << static_cast<uint64_t>(h.mean());
+            for (const auto &p : PERCENTILES)
+                os << std::setw(12) << h.percentile(p.first);
+            os << std::setw(12) << h.max() << "\n";
+        }
+    }
+
+    /**
+     * @brief Writes the latency rows as a JSON array (nanoseconds).
+     */
+    void write_latency_json(std::ostream &os, size_t size, const std::vector<LatencyRow> &rows)
+    {
+        os << "[\n";
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            const bench::Histogram &h = rows[i].histogram;
+            os << "  {\"structure\": \"MyContainer\", \"operation\": \"" << rows[i].operation << "\", \"order\": \""
+               << rows[i].order << "\", \"size\": " << size << ", \"count\": " << h.count() << ", \"mean\": "
+               << h.mean() << ", \"p50\": " << h.percentile(50) << ", \"p90\": " << h.percentile(90)
+               << ", \"p99\": " << h.percentile(99) << ", \"p999\": " << h.percentile(99.9) << ", \"p9999\": "
+               << h.percentile(99.99) << ", \"max\": " << h.max() << "}" << (i + 1 < rows.size() ? "," : "") << "\n";
+        }
+        os << "]\n";
+    }
+
+    /**
+     * @brief Parses --min-size N, --max-size N, --distribution NAME, --seed N, --out FILE, --latency and --perf.
+     */
+    Options parse(int argc, char **argv)
+    {
+        Options opts;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--latency")
+            {
+                opts.latency = true;
+                continue;
+            }
+            if (arg == "--perf")
+            {
+                opts.perf = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+                throw std::invalid_argument("Missing value for " + arg);
+            if (arg == "--min-size")
+                opts.min_size = std::stoull(argv[++i]);
+            else if (arg == "--max-size")
+                opts.max_size = std::stoull(argv[++i]);
+            else if (arg == "--out")
+                opts.out = argv[++i];
+            else if (arg == "--seed")
+                opts.seed = std::stoull(argv[++i]);
+            else if (arg == "--distribution")
+            {
+                std::string wanted = argv[++i];
+                auto it = std::find_if(std::begin(workloads::ALL), std::end(workloads::ALL), [&](workloads::Distribution d)
+                                       { return wanted == workloads::name(d); });
+                if (it == std::end(workloads::ALL))
+                    throw std::invalid_argument("Unknown distribution " + wanted);
+                opts.distribution = *it;
+            }
+            else
+                throw std::invalid_argument("Unknown option " + arg);
+        }
+        if (opts.min_size == 0)
+            opts.min_size = 1;
+        return opts;
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        Options opts = parse(argc, argv);
+        if (opts.latency)
+        {
+            std::vector<int> values = workloads::generate<int>(opts.distribution, opts.max_size, opts.seed);
+            std::vector<LatencyRow> rows = bench_latency(values);
+            print_latency(std::cout, rows);
+            if (!opts.out.empty())
+            {
+                std::ofstream file(opts.out);
+                write_latency_json(file, opts.max_size, rows);
+            }
+            return 0;
+        }
+
+        std::unique_ptr<bench::PerfCounters> counters;
+        if (opts.perf)
+        {
+            counters.reset(new bench::PerfCounters());
+            if (counters->available())
+                perf = counters.get();
+            else
+                std::cerr << "bench: hardware counters unavailable, reporting wall-clock times only\n";
+        }
+
+        std::vector<bench::Result> results;
+        for (size_t n = opts.min_size; n <= opts.max_size; n *= 10)
+        {
+            std::cerr << "size " << n << "...\n";
+            std::vector<int> values = workloads::generate<int>(opts.distribution, n, opts.seed);
+            bench_container(n, values, results);
+            bench_baselines(n, values, results);
+        }
+
+        if (opts.out.empty())
+        {
+            bench::write_json(std::cout, results);
+        }
+        else
+        {
+            std::ofstream file(opts.out);
+            bench::write_json(file, results);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "bench: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+
+#include "MyContainer.hpp"
+
+namespace containers
+{
+
+    /**
+     * @brief A thread-safe wrapper around MyContainer<T> with reader-writer synchronization.
+     *
+     * Any number of readers may hold the container at the same time (shared lock), while
+     * add/remove take an exclusive lock. Readers get a const MyContainer<T>& inside read(),
+     * so every iteration order can be traversed in parallel without tripping the
+     * modification check: no writer can bump the version counter while a reader holds the lock.
+     *
+     * For many concurrent producers, ingest() appends to one of several striped buffers
+     * instead of taking the global lock; buffered elements are spliced in bulk by flush()
+     * or automatically by the next read.
+     *
+     * @tparam T The type of elements stored in the container (default is int).
+     */
+    template <typename T = int>
+    class ConcurrentMyContainer
+    {
+    private:
+        /**
+         * @brief A producer-side buffer, padded to its own cache line to avoid false sharing.
+         */
+        struct alignas(64) Shard
+        {
+            std::mutex mutex;      // Guards buffer; only contended by producers hashed to this shard.
+            std::vector<T> buffer; // Elements ingested but not merged yet.
+        };
+
+        mutable std::shared_mutex mutex;   // Guards container: shared for readers, exclusive for writers.
+        mutable MyContainer<T> container;  // The wrapped container; reads may merge pending ingests into it.
+
+        size_t shard_count;                        // Number of ingestion shards.
+        std::unique_ptr<Shard[]> shards;           // Striped ingestion buffers.
+        mutable std::atomic<size_t> pending{0};    // Elements sitting in shards.
+        mutable uint64_t epoch = 0;                // Bumped by every write; guarded by the exclusive lock.
+
+        mutable std::mutex publish_mutex;                        // Serializes publication of snapshots.
+        mutable std::weak_ptr<const MyContainer<T>> published;   // Latest published epoch (see pin()).
+        mutable uint64_t published_epoch = 0;                    // Epoch published was taken at.
+
+        /**
+         * @brief Splices every shard's buffer into the container; caller holds the exclusive lock.
+         */
+        void merge_shards() const
+        {
+            trace::Scope trace_scope("merge_shards", "mutation", pending.load(std::memory_order_relaxed));
+            std::vector<T> batch;
+            for (size_t i = 0; i < shard_count; ++i)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(shards[i].mutex);
+                    batch.swap(shards[i].buffer);
+                }
+                if (batch.empty())
+                    continue;
+                ++epoch;
+                pending.fetch_sub(batch.size(), std::memory_order_relaxed);
+                container.add_all(batch.begin(), batch.end());
+                batch.clear();
+            }
+        }
+
+        /**
+         * @brief Merges pending ingests, if any, before a read takes its shared lock.
+         */
+        void merge_if_pending() const
+        {
+            if (pending.load(std::memory_order_acquire) != 0)
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex);
+                merge_shards();
+            }
+        }
+
+    public:
+        /**
+         * @brief Constructs an empty container.
+         *
+         * @param shards Number of ingestion buffers (defaults to the hardware thread count).
+         */
+        explicit ConcurrentMyContainer(size_t shards = std::thread::hardware_concurrency())
+            : shard_count(shards == 0 ? 1 : shards), shards(new Shard[shard_count]) {}
+
+        /**
+         * @brief Adds a new element to the container under an exclusive lock.
+         *
+         * @param value The value to be added.
+         */
+        void add(const T &value)
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            container.add(value);
+            ++epoch;
+        }
+
+        /**
+         * @brief Buffers an element without touching the global lock.
+         *
+         * The calling thread is hashed to one shard, so elements from one thread keep their
+         * relative order. They become visible after flush() or on the next read; across
+         * threads, merged elements are grouped by shard rather than interleaved by time.
+         *
+         * @param value The value to be added.
+         */
+        void ingest(const T &value)
+        {
+            Shard &shard = shards[std::hash<std::thread::id>{}(std::this_thread::get_id()) % shard_count];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.buffer.push_back(value);
+            pending.fetch_add(1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Merges all buffered ingests into the container in bulk.
+         */
+        void flush()
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            merge_shards();
+        }
+
+        /**
+         * @brief Removes an element from the container under an exclusive lock.
+         *
+         * @param value The value to be removed.
+         * @throws std::runtime_error if element is not found.
+         */
+        void remove(const T &value)
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            merge_shards();
+            container.remove(value);
+            ++epoch;
+        }
+
+        /**
+         * @brief Returns the number of elements in the container.
+         *
+         * @return size_t Number of elements.
+         */
+        size_t size() const
+        {
+            merge_if_pending();
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            return container.size();
+        }
+
+        /**
+         * @brief Runs a read-only operation while holding a shared lock.
+         *
+         * Multiple read() calls run concurrently; writers wait until all of them return.
+         * Iterators obtained inside fn must not escape it.
+         *
+         * @param fn Callable invoked as fn(const MyContainer<T>&).
+         * @return Whatever fn returns.
+         */
+        template <typename Fn>
+        decltype(auto) read(Fn &&fn) const
+        {
+            merge_if_pending();
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            return fn(static_cast<const MyContainer<T> &>(container));
+        }
+
+        /**
+         * @brief Runs a mutating operation while holding an exclusive lock.
+         *
+         * Useful for applying several mutations atomically with respect to readers.
+         *
+         * @param fn Callable invoked as fn(MyContainer<T>&).
+         * @return Whatever fn returns.
+         */
+        template <typename Fn>
+        decltype(auto) write(Fn &&fn)
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            merge_shards();
+            ++epoch; // fn may replace the container wholesale, so version() cannot tell.
+            return fn(container);
+        }
+
+        /**
+         * @brief Pins an immutable snapshot of the current epoch for lock-free iteration.
+         *
+         * The snapshot is published RCU-style: it is built once per epoch of the wrapper, which
+         * every add, remove, merge and write() advances (the first pin() after a write takes an O(1) copy-on-write clone under a shared lock) and then handed
+         * out to every reader of that version. Iterators over a snapshot never throw "Container
+         * was modified during iteration", since nothing ever mutates it, and writers are not
+         * blocked while the scan runs. An epoch is reclaimed when its last reader drops the
+         * pointer; only writes made while an epoch is still pinned pay for a detaching copy.
+         *
+         * @return std::shared_ptr<const MyContainer<T>> The pinned snapshot.
+         */
+        std::shared_ptr<const MyContainer<T>> pin() const
+        {
+            merge_if_pending();
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            std::lock_guard<std::mutex> publish_lock(publish_mutex);
+            auto snapshot = published.lock();
+            if (!snapshot || published_epoch != epoch)
+            {
+                snapshot = std::make_shared<const MyContainer<T>>(container);
+                published = snapshot;
+                published_epoch = epoch;
+            }
+            return snapshot;
+        }
+
+        /**
+         * @brief Prints the container's elements in insertion order under a shared lock.
+         *
+         * @param os Output stream.
+         * @param c Container to be printed.
+         * @return std::ostream& Reference to the output stream.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const ConcurrentMyContainer<T> &c)
+        {
+            c.merge_if_pending();
+            std::shared_lock<std::shared_mutex> lock(c.mutex);
+            return os << c.container;
+        }
+    };
+
+}
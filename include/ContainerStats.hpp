@@ -0,0 +1,278 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace containers
+{
+
+    /**
+     * @brief Names the six iteration orders, for APIs that take the order as a value.
+     */
+    enum class Order
+    {
+        Ascending,
+        Descending,
+        SideCross,
+        Reverse,
+        Regular,
+        MiddleOut
+    };
+
+    constexpr size_t ORDER_COUNT = 6; // Number of Order values.
+
+    /**
+     * @brief Point-in-time copy of a container's runtime statistics.
+     *
+     * Statistics are only collected when the program is compiled with MYCONTAINER_STATS
+     * defined (before including MyContainer.hpp); otherwise `enabled` is false and every
+     * field stays zero, and the containers carry no counters at all.
+     */
+    struct ContainerStats
+    {
+#ifdef MYCONTAINER_STATS
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        size_t adds = 0;                                // Elements added (add() and add_all()).
+        size_t removes = 0;                             // Successful remove() calls.
+        size_t iterator_constructions[ORDER_COUNT] = {}; // Iterators built, indexed by Order.
+        size_t sorts = 0;                               // Ascending permutations computed.
+        uint64_t sort_ns = 0;                           // Wall-clock nanoseconds spent in those sorts.
+        size_t sort_cache_hits = 0;                     // Sorted-permutation requests served from the cache.
+        size_t sort_cache_misses = 0;                   // Requests that had to sort.
+        size_t bytes_allocated = 0;                     // Bytes of element buffers, permutations and iterator indices allocated.
+        size_t modification_errors = 0;                 // "Container was modified during iteration" exceptions thrown.
+
+        /**
+         * @brief Returns the number of iterators built for one order.
+         */
+        size_t iterators(Order order) const
+        {
+            return iterator_constructions[static_cast<size_t>(order)];
+        }
+    };
+
+    /**
+     * @brief Fixed-bucket latency histogram with cumulative-friendly atomic counts.
+     *
+     * Bucket upper bounds are decades from 1 microsecond to 10 seconds, plus an overflow
+     * bucket, matching the `le` buckets of a Prometheus histogram.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr size_t BOUNDS = 8; // Finite buckets.
+        static constexpr uint64_t BOUND_NS[BOUNDS] = {1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+                                                     10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL};
+
+    private:
+        std::atomic<uint64_t> buckets[BOUNDS + 1] = {}; // Non-cumulative counts; the last is +Inf.
+        std::atomic<uint64_t> sum_ns{0};                // Sum of observations.
+
+    public:
+        /**
+         * @brief Records one observation.
+         */
+        void observe(uint64_t ns)
+        {
+            size_t b = 0;
+            while (b < BOUNDS && ns > BOUND_NS[b])
+                ++b;
+            buckets[b].fetch_add(1, std::memory_order_relaxed);
+            sum_ns.fetch_add(ns, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the number of observations at or below BOUND_NS[b] (b == BOUNDS means all).
+         */
+        uint64_t cumulative(size_t b) const
+        {
+            uint64_t total = 0;
+            for (size_t i = 0; i <= b && i <= BOUNDS; ++i)
+                total += buckets[i].load(std::memory_order_relaxed);
+            return total;
+        }
+
+        /**
+         * @brief Returns the number of observations.
+         */
+        uint64_t count() const
+        {
+            return cumulative(BOUNDS);
+        }
+
+        /**
+         * @brief Returns the sum of observations in nanoseconds.
+         */
+        uint64_t sum() const
+        {
+            return sum_ns.load(std::memory_order_relaxed);
+        }
+    };
+
+    struct MetricsSeries;
+
+    /**
+     * @brief Relaxed atomic counters behind ContainerStats, owned by one container object.
+     *
+     * Const operations (iteration, sorting) update them, possibly from several reader
+     * threads, hence the atomics. Counters describe the object they live in: copying a
+     * container does not copy them, and the copy starts from zero. A named container
+     * (see MyContainer::set_metrics_name()) also forwards every event to the shared
+     * MetricsSeries of that name; copies keep forwarding to it.
+     */
+    class StatsCounters
+    {
+    private:
+        std::atomic<size_t> adds{0};
+        std::atomic<size_t> removes{0};
+        std::atomic<size_t> iterators[ORDER_COUNT] = {};
+        std::atomic<size_t> sorts{0};
+        std::atomic<uint64_t> sort_ns{0};
+        std::atomic<size_t> cache_hits{0};
+        std::atomic<size_t> cache_misses{0};
+        std::atomic<size_t> bytes{0};
+        std::atomic<size_t> modification_errors{0};
+        std::shared_ptr<MetricsSeries> series; // Aggregate this object reports into, if named.
+
+        static void bump(std::atomic<size_t> &counter, size_t by = 1)
+        {
+            counter.fetch_add(by, std::memory_order_relaxed);
+        }
+
+    public:
+        StatsCounters() = default;
+        StatsCounters(const StatsCounters &other) : series(other.series) {}
+        StatsCounters &operator=(const StatsCounters &other)
+        {
+            series = other.series;
+            return *this;
+        }
+
+        /**
+         * @brief Starts (or, with nullptr, stops) forwarding events to an aggregate series.
+         */
+        void attach(std::shared_ptr<MetricsSeries> target) { series = std::move(target); }
+
+        /**
+         * @brief Tells whether latencies are wanted, i.e. whether a series is attached.
+         */
+        bool timed() const { return series != nullptr; }
+
+        inline void record_adds(size_t n);
+        inline void record_remove();
+        inline void record_iterator(Order order, uint64_t build_ns);
+        inline void record_sort(uint64_t ns);
+        inline void record_cache(bool hit);
+        inline void record_bytes(size_t n);
+        inline void record_modification_error();
+
+        /**
+         * @brief Reads every counter (each individually atomic, not as one consistent cut).
+         */
+        ContainerStats snapshot() const
+        {
+            ContainerStats s;
+            s.adds = adds.load(std::memory_order_relaxed);
+            s.removes = removes.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < ORDER_COUNT; ++i)
+                s.iterator_constructions[i] = iterators[i].load(std::memory_order_relaxed);
+            s.sorts = sorts.load(std::memory_order_relaxed);
+            s.sort_ns = sort_ns.load(std::memory_order_relaxed);
+            s.sort_cache_hits = cache_hits.load(std::memory_order_relaxed);
+            s.sort_cache_misses = cache_misses.load(std::memory_order_relaxed);
+            s.bytes_allocated = bytes.load(std::memory_order_relaxed);
+            s.modification_errors = modification_errors.load(std::memory_order_relaxed);
+            return s;
+        }
+
+        /**
+         * @brief Zeroes every counter (the attached series is left alone).
+         */
+        void reset()
+        {
+            adds.store(0, std::memory_order_relaxed);
+            removes.store(0, std::memory_order_relaxed);
+            for (auto &counter : iterators)
+                counter.store(0, std::memory_order_relaxed);
+            sorts.store(0, std::memory_order_relaxed);
+            sort_ns.store(0, std::memory_order_relaxed);
+            cache_hits.store(0, std::memory_order_relaxed);
+            cache_misses.store(0, std::memory_order_relaxed);
+            bytes.store(0, std::memory_order_relaxed);
+            modification_errors.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Statistics aggregated over every container reporting under one name.
+     */
+    struct MetricsSeries
+    {
+        StatsCounters totals;                          // Sum of the members' counters.
+        LatencyHistogram iterator_build[ORDER_COUNT];  // Iterator construction latency, indexed by Order.
+        LatencyHistogram sort;                         // Sorted-permutation build latency.
+    };
+
+    inline void StatsCounters::record_adds(size_t n)
+    {
+        bump(adds, n);
+        if (series)
+            series->totals.record_adds(n);
+    }
+
+    inline void StatsCounters::record_remove()
+    {
+        bump(removes);
+        if (series)
+            series->totals.record_remove();
+    }
+
+    inline void StatsCounters::record_iterator(Order order, uint64_t build_ns)
+    {
+        bump(iterators[static_cast<size_t>(order)]);
+        if (series)
+        {
+            series->totals.record_iterator(order, build_ns);
+            series->iterator_build[static_cast<size_t>(order)].observe(build_ns);
+        }
+    }
+
+    inline void StatsCounters::record_sort(uint64_t ns)
+    {
+        bump(sorts);
+        sort_ns.fetch_add(ns, std::memory_order_relaxed);
+        if (series)
+        {
+            series->totals.record_sort(ns);
+            series->sort.observe(ns);
+        }
+    }
+
+    inline void StatsCounters::record_cache(bool hit)
+    {
+        bump(hit ? cache_hits : cache_misses);
+        if (series)
+            series->totals.record_cache(hit);
+    }
+
+    inline void StatsCounters::record_bytes(size_t n)
+    {
+        bump(bytes, n);
+        if (series)
+            series->totals.record_bytes(n);
+    }
+
+    inline void StatsCounters::record_modification_error()
+    {
+        bump(modification_errors);
+        if (series)
+            series->totals.record_modification_error();
+    }
+
+}
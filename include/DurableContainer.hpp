@@ -0,0 +1,162 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <unistd.h>
+
+#include "MyContainer.hpp"
+#include "WriteAheadLog.hpp"
+
+namespace containers
+{
+
+    /**
+     * @brief A MyContainer whose mutations are made durable through a write-ahead log.
+     *
+     * State lives in two files: `<prefix>.snap`, a snapshot written by checkpoint(), and
+     * `<prefix>.wal`, the operations since that snapshot. Opening replays the log on top of the
+     * snapshot; every add/remove is appended to the log with group commit, and a checkpoint is
+     * taken automatically every `checkpoint_every` operations to keep replay short.
+     *
+     * @tparam T The type of elements stored in the container (must be trivially copyable).
+     */
+    template <typename T = int>
+    class DurableContainer
+    {
+    private:
+        using Log = WriteAheadLog<T>;
+
+        std::string snapshot_path;  // Checkpoint snapshot.
+        MyContainer<T> container;   // In-memory state.
+        Log log;                    // Operations since the checkpoint.
+        size_t checkpoint_every;    // Operations between automatic checkpoints (0 = never).
+        size_t since_checkpoint = 0; // Operations logged since the last checkpoint.
+
+        /**
+         * @brief Loads the snapshot if one exists.
+         */
+        static MyContainer<T> load_snapshot(const std::string &path)
+        {
+            if (::access(path.c_str(), F_OK) != 0)
+                return MyContainer<T>();
+            return MyContainer<T>::load(path);
+        }
+
+        /**
+         * @brief Counts an operation and checkpoints when the threshold is reached.
+         */
+        void logged()
+        {
+            if (checkpoint_every != 0 && ++since_checkpoint >= checkpoint_every)
+                checkpoint();
+        }
+
+    public:
+        /**
+         * @brief Opens the container stored under prefix, replaying its log.
+         *
+         * Records already covered by the snapshot (a crash between writing the snapshot and
+         * resetting the log) are skipped by comparing versions. A log based on a newer version
+         * than the snapshot (the snapshot it was reset after is missing or was replaced by an
+         * older one) cannot be replayed and is rejected rather than silently losing operations.
+         *
+         * @param prefix Path prefix of the `.snap` and `.wal` files.
+         * @param options Group-commit triggers of the log.
+         * @param checkpoint_every Operations between automatic checkpoints (0 = only explicit ones).
+         * @throws std::runtime_error if the files cannot be read, are corrupt or do not belong together.
+         */
+        explicit DurableContainer(const std::string &prefix, WalOptions options = WalOptions(),
+                                  size_t checkpoint_every = 1000000)
+            : snapshot_path(prefix + ".snap"), container(load_snapshot(snapshot_path)),
+              log(prefix + ".wal", options), checkpoint_every(checkpoint_every)
+        {
+            size_t base = container.version();
+            if (log.base_version() > base)
+                throw std::runtime_error("Write-ahead log " + prefix + ".wal starts at version " +
+                                         std::to_string(log.base_version()) + " but the snapshot is at version " +
+                                         std::to_string(base));
+            since_checkpoint = log.replay([&](typename Log::Op op, const T &value, uint64_t version)
+                                          {
+                                              if (version <= base)
+                                                  return;
+                                              if (op == Log::Op::Add)
+                                                  container.add(value);
+                                              else
+                                                  container.remove(value); });
+        }
+
+        /**
+         * @brief Logs a value and then adds it; durable after the next group commit.
+         *
+         * @param value The value to be added.
+         * @throws std::runtime_error if the log fails (the container is left unchanged).
+         */
+        void add(const T &value)
+        {
+            log.append(Log::Op::Add, value);
+            container.add(value);
+            logged();
+        }
+
+        /**
+         * @brief Logs a removal and then applies it; durable after the next group commit.
+         *
+         * @param value The value to be removed.
+         * @throws std::runtime_error if element is not found (nothing is logged), or if the
+         * log fails (the container is left unchanged).
+         */
+        void remove(const T &value)
+        {
+            if (!container.contains(value))
+                throw std::runtime_error("Element was not found");
+            log.append(Log::Op::Remove, value);
+            container.remove(value);
+            logged();
+        }
+
+        /**
+         * @brief Blocks until every operation so far is on disk.
+         */
+        void sync()
+        {
+            log.commit();
+        }
+
+        /**
+         * @brief Writes a snapshot of the current state and truncates the log.
+         *
+         * The snapshot is published atomically and its directory entry synced before the log
+         * is reset, so a crash at any point leaves a state that replays to the same container.
+         */
+        void checkpoint()
+        {
+            trace::Scope trace_scope("checkpoint", "compaction", container.size());
+            log.commit();
+            container.save(snapshot_path);
+            log.reset(container.version());
+            since_checkpoint = 0;
+        }
+
+        /**
+         * @brief Returns the in-memory container for reading and iteration.
+         *
+         * @return const MyContainer<T>& The current state.
+         */
+        const MyContainer<T> &view() const
+        {
+            return container;
+        }
+
+        /**
+         * @brief Returns the number of elements in the container.
+         *
+         * @return size_t Number of elements.
+         */
+        size_t size() const
+        {
+            return container.size();
+        }
+    };
+
+}
@@ -0,0 +1,382 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+namespace containers
+{
+
+    /**
+     * @brief Ascending or descending traversal of a large buffer via external merge sort.
+     *
+     * Construction splits the input into runs that fit in the memory budget, sorts each run and
+     * spills it to an anonymous temporary file. Iteration then k-way merges the runs lazily: each
+     * run is read through a small buffer, so at most `memory_budget` bytes of elements are held
+     * at any time. Elements are yielded by value; ties keep no particular order.
+     *
+     * At most fan_in() runs are ever merged at once (and held open): whenever that many runs of
+     * the same generation exist they are merged into one run of the next generation, and the
+     * remaining runs are merged down to fan_in() before iteration. The fan-in is derived from the
+     * budget so every run buffer still holds MIN_CHUNK elements, and capped at MAX_FAN_IN.
+     *
+     * @tparam T The element type (must be trivially copyable).
+     */
+    template <typename T>
+    class ExternalSortedRange
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ExternalSortedRange requires a trivially copyable type");
+
+    private:
+        /**
+         * @brief Closes a temporary run file.
+         */
+        struct FileCloser
+        {
+            void operator()(std::FILE *f) const
+            {
+                if (f)
+                    std::fclose(f);
+            }
+        };
+        using File = std::shared_ptr<std::FILE>;
+
+        /**
+         * @brief One sorted run on disk, removed automatically when closed.
+         */
+        struct Run
+        {
+            File file;     // Run file.
+            size_t length; // Number of elements in the run.
+        };
+
+    public:
+        static constexpr size_t MIN_CHUNK = 64;  // Elements per run buffer the fan-in is chosen to keep.
+        static constexpr size_t MAX_FAN_IN = 64; // Upper bound on runs merged (and files open) at once.
+
+    private:
+        std::vector<Run> runs;                  // Runs left for the final merge (at most fan_in()).
+        std::vector<std::vector<Run>> pending;  // Runs still being produced, by merge generation.
+        size_t memory_budget;                   // Bytes of elements the sort may hold in memory.
+        bool descending;                        // Merge order.
+        size_t spilled = 0;                     // Runs written by the initial sort.
+        size_t merges = 0;                      // Intermediate merges performed.
+
+        [[noreturn]] static void fail(const std::string &what)
+        {
+            throw std::runtime_error(what + ": " + std::strerror(errno));
+        }
+
+        /**
+         * @brief Opens an empty anonymous run file.
+         */
+        static Run create_run()
+        {
+            std::FILE *raw = std::tmpfile();
+            if (!raw)
+                fail("Failed to create temporary run file");
+            return Run{File(raw, FileCloser()), 0};
+        }
+
+        /**
+         * @brief Appends n elements to a run.
+         */
+        static void write_run(Run &run, const T *elements, size_t n)
+        {
+            if (std::fwrite(elements, sizeof(T), n, run.file.get()) != n || std::fflush(run.file.get()) != 0)
+                fail("Failed to write sorted run");
+            run.length += n;
+        }
+
+        /**
+         * @brief Merges k runs into a new run, within the memory budget (k input buffers plus one output buffer).
+         */
+        Run merge(const Run *group, size_t k)
+        {
+            size_t chunk = std::max<size_t>(1, memory_budget / sizeof(T) / (k + 1));
+            Run out = create_run();
+            std::vector<T> buffer;
+            buffer.reserve(chunk);
+            for (Iterator it(group, k, chunk, descending), end; it != end; ++it)
+            {
+                buffer.push_back(*it);
+                if (buffer.size() == chunk)
+                {
+                    write_run(out, buffer.data(), buffer.size());
+                    buffer.clear();
+                }
+            }
+            write_run(out, buffer.data(), buffer.size());
+            ++merges;
+            return out;
+        }
+
+        /**
+         * @brief Adds a run to a generation, merging the generation into the next one once it holds fan_in() runs.
+         */
+        void add_run(Run run, size_t generation)
+        {
+            if (pending.size() <= generation)
+                pending.resize(generation + 1);
+            pending[generation].push_back(std::move(run));
+            if (pending[generation].size() < fan_in())
+                return;
+            Run merged = merge(pending[generation].data(), pending[generation].size());
+            pending[generation].clear();
+            add_run(std::move(merged), generation + 1);
+        }
+
+    public:
+        /**
+         * @brief Lazy k-way merge over the spilled runs.
+         */
+        class Iterator
+        {
+        private:
+            /**
+             * @brief Buffered reader over one run.
+             */
+            struct Cursor
+            {
+                std::FILE *file;       // Run file.
+                size_t remaining;      // Elements not yet read from the file.
+                std::vector<T> buffer; // Elements read but not yet consumed.
+                size_t pos = 0;        // Next element in buffer.
+            };
+
+            std::vector<Cursor> cursors; // One cursor per run.
+            std::vector<size_t> heap;    // Heap of cursor ids ordered by their current element.
+            size_t chunk = 0;            // Elements per cursor refill.
+            bool descending = false;     // Merge order.
+            bool at_end = true;          // True once every run is exhausted.
+
+            const T &head(size_t c) const { return cursors[c].buffer[cursors[c].pos]; }
+
+            /**
+             * @brief Heap comparator: puts the smallest (or largest) head on top.
+             */
+            bool later(size_t a, size_t b) const
+            {
+                return descending ? head(a) < head(b) : head(b) < head(a);
+            }
+
+            /**
+             * @brief Makes sure cursor c has a buffered element; returns false when its run is exhausted.
+             */
+            bool fill(size_t c)
+            {
+                Cursor &cur = cursors[c];
+                if (cur.pos < cur.buffer.size())
+                    return true;
+                if (cur.remaining == 0)
+                    return false;
+                size_t n = std::min(chunk, cur.remaining);
+                cur.buffer.resize(n);
+                if (std::fread(cur.buffer.data(), sizeof(T), n, cur.file) != n)
+                    fail("Failed to read sorted run");
+                cur.remaining -= n;
+                cur.pos = 0;
+                return true;
+            }
+
+            void push(size_t c)
+            {
+                heap.push_back(c);
+                std::push_heap(heap.begin(), heap.end(), [this](size_t a, size_t b)
+                               { return later(a, b); });
+            }
+
+        public:
+            /**
+             * @brief Constructs the end iterator.
+             */
+            Iterator() = default;
+
+            /**
+             * @brief Starts merging the runs of range, splitting the memory budget between them.
+             */
+            explicit Iterator(const ExternalSortedRange &range)
+                : Iterator(range.runs.data(), range.runs.size(),
+                           range.runs.empty() ? 0 : range.memory_budget / sizeof(T) / range.runs.size(),
+                           range.descending) {}
+
+            /**
+             * @brief Starts merging k runs, reading each through a buffer of chunk elements.
+             */
+            Iterator(const Run *runs, size_t k, size_t chunk_elements, bool order_descending)
+                : chunk(std::max<size_t>(1, chunk_elements)), descending(order_descending)
+            {
+                if (k == 0)
+                    return;
+                cursors.reserve(k);
+                for (size_t c = 0; c < k; ++c)
+                {
+                    std::FILE *f = runs[c].file.get();
+                    std::rewind(f);
+                    cursors.push_back(Cursor{f, runs[c].length, {}});
+                }
+                for (size_t c = 0; c < k; ++c)
+                    if (fill(c))
+                        push(c);
+                at_end = heap.empty();
+            }
+
+            /**
+             * @brief Dereference operator to access the current element.
+             *
+             * @return const T& The next element in sorted order.
+             * @throws std::out_of_range If the iterator is out of bounds.
+             */
+            const T &operator*() const
+            {
+                if (at_end)
+                {
+                    throw std::out_of_range("Iterator out of bounds");
+                }
+                return head(heap.front());
+            }
+
+            /**
+             * @brief Prefix increment operator: consumes the current element and refills its run.
+             *
+             * @return Iterator& Reference to this iterator.
+             * @throws std::out_of_range If the iterator is out of bounds.
+             */
+            Iterator &operator++()
+            {
+                if (at_end)
+                {
+                    throw std::out_of_range("Iterator out of bounds");
+                }
+                auto cmp = [this](size_t a, size_t b)
+                { return later(a, b); };
+                std::pop_heap(heap.begin(), heap.end(), cmp);
+                size_t c = heap.back();
+                heap.pop_back();
+                ++cursors[c].pos;
+                if (fill(c))
+                    push(c);
+                at_end = heap.empty();
+                return *this;
+            }
+
+            /**
+             * @brief Two iterators are equal when both are exhausted (only end comparisons are meaningful).
+             */
+            bool operator==(const Iterator &other) const { return at_end && other.at_end; }
+
+            /**
+             * @brief Inequality operator.
+             */
+            bool operator!=(const Iterator &other) const { return !(*this == other); }
+        };
+
+        /**
+         * @brief Sorts data[0, n) into runs of at most memory_budget bytes and spills them to temporary files.
+         *
+         * @param data Pointer to the elements (e.g. MappedContainer::data()).
+         * @param n Number of elements.
+         * @param memory_budget Bytes of elements held in memory at once (raised to three elements if smaller).
+         * @param descending If true, the merge yields the largest element first.
+         * @throws std::runtime_error if a temporary file cannot be created or written.
+         */
+        ExternalSortedRange(const T *data, size_t n, size_t memory_budget, bool descending = false)
+            : memory_budget(std::max(memory_budget, 3 * sizeof(T))), descending(descending)
+        {
+            size_t run_length = this->memory_budget / sizeof(T);
+            std::vector<T> run;
+            run.reserve(std::min(run_length, n));
+            for (size_t begin = 0; begin < n; begin += run_length)
+            {
+                size_t len = std::min(run_length, n - begin);
+                run.assign(data + begin, data + begin + len);
+                if (descending)
+                    std::sort(run.begin(), run.end(), [](const T &a, const T &b)
+                              { return b < a; });
+                else
+                    std::sort(run.begin(), run.end());
+
+                Run spill = create_run();
+                write_run(spill, run.data(), len);
+                ++spilled;
+                if (!pending.empty() && pending[0].size() + 1 >= fan_in())
+                    std::vector<T>().swap(run); // the merge this triggers gets the whole budget
+                add_run(std::move(spill), 0);
+            }
+            std::vector<T>().swap(run);
+            for (auto &generation : pending)
+                for (auto &r : generation)
+                    runs.push_back(std::move(r));
+            pending.clear();
+            while (runs.size() > fan_in())
+            {
+                // Merge just enough of the oldest (smallest) runs to leave exactly fan_in().
+                size_t group = std::min(fan_in(), runs.size() - fan_in() + 1);
+                Run merged = merge(runs.data(), group);
+                runs.erase(runs.begin(), runs.begin() + static_cast<std::ptrdiff_t>(group));
+                runs.push_back(std::move(merged));
+            }
+        }
+
+        /**
+         * @brief Returns the maximum number of runs merged at once for this budget.
+         *
+         * @return size_t Between 2 and MAX_FAN_IN.
+         */
+        size_t fan_in() const
+        {
+            return std::min(MAX_FAN_IN, std::max<size_t>(2, memory_budget / sizeof(T) / MIN_CHUNK));
+        }
+
+        /**
+         * @brief Returns the number of intermediate merges performed before iteration.
+         *
+         * @return size_t 0 when the spilled runs fit in a single merge.
+         */
+        size_t merge_count() const
+        {
+            return merges;
+        }
+
+        /**
+         * @brief Returns the number of runs spilled by the initial sort.
+         *
+         * @return size_t Run count.
+         */
+        size_t run_count() const
+        {
+            return spilled;
+        }
+
+        /**
+         * @brief Returns an iterator to the first element; the merge starts over on every call.
+         *
+         * Only one iterator from a given range may be advanced at a time (they share the run files).
+         *
+         * @return Iterator Iterator to the beginning.
+         */
+        Iterator begin() const
+        {
+            return Iterator(*this);
+        }
+
+        /**
+         * @brief Returns the end iterator.
+         *
+         * @return Iterator Iterator to the end.
+         */
+        Iterator end() const
+        {
+            return Iterator();
+        }
+    };
+
+}
@@ -0,0 +1,143 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace containers
+{
+
+    /**
+     * @brief Copy of a container's sorted keys in Eytzinger (BFS) layout, for cache-friendly searches.
+     *
+     * Node k's children are 2k and 2k+1, so the first levels of every search share a few
+     * cache lines, and the descendants four levels down are contiguous and prefetched while
+     * the current level is compared. Searches are branch-free and never touch the
+     * container's data. Each node also stores its position in ascending order, so results
+     * are positions in the container's sorted permutation.
+     *
+     * Costs one copy of every key plus one size_t per element; it is rebuilt from scratch
+     * for every version, so it suits read-mostly containers (see MyContainer::use_search_index()).
+     *
+     * @tparam T The key type; must be copyable and ordered by operator<.
+     */
+    template <typename T>
+    class EytzingerIndex
+    {
+    private:
+        std::vector<T> keys;           // keys[k] is node k (1-based; keys[0] is unused).
+        std::vector<size_t> positions; // positions[k] is node k's position in ascending order.
+
+        /**
+         * @brief Keys per cache line; prefetching node k * LINE fetches k's great-great-grandchildren.
+         */
+        static constexpr size_t LINE = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+
+        /**
+         * @brief Fills the subtree rooted at k in order from the sorted keys, advancing next.
+         */
+        void fill(const std::vector<T> &data, const std::vector<size_t> &sorted, size_t k, size_t &next)
+        {
+            if (k >= keys.size())
+                return;
+            fill(data, sorted, 2 * k, next);
+            keys[k] = data[sorted[next]];
+            positions[k] = next++;
+            fill(data, sorted, 2 * k + 1, next);
+        }
+
+        /**
+         * @brief Hints the cache to load node k's descendants LINE levels down (trivially copyable keys only).
+         */
+        void prefetch(size_t k) const
+        {
+#if defined(__GNUC__)
+            if constexpr (std::is_trivially_copyable<T>::value)
+                __builtin_prefetch(reinterpret_cast<const void *>(reinterpret_cast<uintptr_t>(keys.data()) +
+                                                                   k * LINE * sizeof(T)));
+#else
+            (void)k;
+#endif
+        }
+
+        /**
+         * @brief Maps the node index a search fell off the tree at to a position in ascending order.
+         *
+         * The answer is the last node where the search went left: strip the trailing right
+         * turns (1 bits) and that left turn. Index 0 means it never went left (no answer).
+         */
+        size_t resolve(size_t k) const
+        {
+#if defined(__GNUC__)
+            k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+#else
+            while (k & 1)
+                k >>= 1;
+            k >>= 1;
+#endif
+            return k == 0 ? size() : positions[k];
+        }
+
+    public:
+        /**
+         * @brief Builds the layout from a container's elements and their ascending permutation.
+         *
+         * @param data The container's elements.
+         * @param sorted Indices into data in ascending order.
+         */
+        EytzingerIndex(const std::vector<T> &data, const std::vector<size_t> &sorted)
+            : keys(sorted.size() + 1), positions(sorted.size() + 1)
+        {
+            size_t next = 0;
+            fill(data, sorted, 1, next);
+        }
+
+        /**
+         * @brief Returns the number of keys.
+         */
+        size_t size() const
+        {
+            return keys.size() - 1;
+        }
+
+        /**
+         * @brief Returns the heap memory held by the index in bytes.
+         */
+        size_t memory_bytes() const
+        {
+            return keys.capacity() * sizeof(T) + positions.capacity() * sizeof(size_t);
+        }
+
+        /**
+         * @brief Returns the position in ascending order of the first key not less than value (size() if none).
+         */
+        size_t lower_bound(const T &value) const
+        {
+            size_t n = size();
+            size_t k = 1;
+            while (k <= n)
+            {
+                prefetch(k);
+                k = 2 * k + static_cast<size_t>(keys[k] < value);
+            }
+            return resolve(k);
+        }
+
+        /**
+         * @brief Returns the position in ascending order of the first key greater than value (size() if none).
+         */
+        size_t upper_bound(const T &value) const
+        {
+            size_t n = size();
+            size_t k = 1;
+            while (k <= n)
+            {
+                prefetch(k);
+                k = 2 * k + static_cast<size_t>(!(value < keys[k]));
+            }
+            return resolve(k);
+        }
+    };
+
+}
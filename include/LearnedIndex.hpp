@@ -0,0 +1,173 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace containers
+{
+
+    /**
+     * @brief Tells whether LearnedIndex supports keys of type T (integral types other than bool).
+     */
+    template <typename T>
+    constexpr bool learnable_key = std::is_integral<T>::value && !std::is_same<T, bool>::value;
+
+    /**
+     * @brief Piecewise linear model of a container's sorted integer keys (PGM-style learned index).
+     *
+     * The distinct keys are split greedily into segments (shrinking-cone fit) so that, for
+     * every stored key, the line of its segment predicts the key's first position in ascending
+     * order within +-epsilon. A lookup binary-searches the few segment start keys, evaluates
+     * one line and then searches a window of about 2 * epsilon positions of the container's
+     * sorted permutation. The window is widened exponentially if it turns out not to bracket
+     * the answer (possible for absent keys next to long runs of duplicates), so results are
+     * always exact.
+     *
+     * Only the segments are stored: sizeof(T) + 2 * 8 bytes each. Regular keys such as
+     * timestamps or sequential ids fit in a handful of segments regardless of their number.
+     *
+     * @tparam T An integral key type (see learnable_key).
+     */
+    template <typename T>
+    class LearnedIndex
+    {
+    private:
+        using Unsigned = std::make_unsigned_t<T>;
+
+        std::vector<T> first_keys;        // First key of each segment, ascending.
+        std::vector<size_t> first_pos;    // Position in ascending order of each segment's first key.
+        std::vector<double> slopes;       // Positions per key unit of each segment.
+        size_t epsilon;                   // Maximum prediction error for stored keys.
+        size_t count;                     // Number of keys modelled.
+
+        /**
+         * @brief Returns hi - lo for hi >= lo as a double, without signed overflow.
+         */
+        static double span(T hi, T lo)
+        {
+            return static_cast<double>(static_cast<Unsigned>(static_cast<Unsigned>(hi) - static_cast<Unsigned>(lo)));
+        }
+
+        /**
+         * @brief Closes the current segment with a slope inside its feasible cone.
+         */
+        void close_segment(double slope_lo, double slope_hi)
+        {
+            slopes.push_back(slope_hi == std::numeric_limits<double>::infinity() ? slope_lo : (slope_lo + slope_hi) / 2);
+        }
+
+    public:
+        /**
+         * @brief Fits the model to a container's elements and their ascending permutation.
+         *
+         * @param data The container's elements.
+         * @param sorted Indices into data in ascending order.
+         * @param max_error The error bound epsilon (at least 1).
+         */
+        LearnedIndex(const std::vector<T> &data, const std::vector<size_t> &sorted, size_t max_error)
+            : epsilon(std::max<size_t>(max_error, 1)), count(sorted.size())
+        {
+            static_assert(learnable_key<T>, "LearnedIndex requires an integral key type");
+            const double eps = static_cast<double>(epsilon);
+            double slope_lo = 0, slope_hi = std::numeric_limits<double>::infinity();
+            for (size_t i = 0; i < sorted.size(); ++i)
+            {
+                T key = data[sorted[i]];
+                if (i > 0 && key == data[sorted[i - 1]])
+                    continue;
+                if (!first_keys.empty())
+                {
+                    double dx = span(key, first_keys.back());
+                    double dy = static_cast<double>(i - first_pos.back());
+                    double lo = (dy - eps) / dx, hi = (dy + eps) / dx;
+                    if (lo <= slope_hi && hi >= slope_lo)
+                    {
+                        slope_lo = std::max(slope_lo, lo);
+                        slope_hi = std::min(slope_hi, hi);
+                        continue;
+                    }
+                    close_segment(slope_lo, slope_hi);
+                }
+                first_keys.push_back(key);
+                first_pos.push_back(i);
+                slope_lo = 0;
+                slope_hi = std::numeric_limits<double>::infinity();
+            }
+            if (!first_keys.empty())
+                close_segment(slope_lo, slope_hi);
+        }
+
+        /**
+         * @brief Returns the number of linear segments.
+         */
+        size_t segments() const
+        {
+            return first_keys.size();
+        }
+
+        /**
+         * @brief Returns the error bound epsilon the model was fitted with.
+         */
+        size_t error_bound() const
+        {
+            return epsilon;
+        }
+
+        /**
+         * @brief Returns the heap memory held by the model in bytes.
+         */
+        size_t memory_bytes() const
+        {
+            return first_keys.capacity() * sizeof(T) + first_pos.capacity() * sizeof(size_t) +
+                   slopes.capacity() * sizeof(double);
+        }
+
+        /**
+         * @brief Returns the position in ascending order of the first key not less than value (count if none).
+         *
+         * @param data The elements the model was fitted to.
+         * @param sorted Their ascending permutation.
+         * @param value The value to search for.
+         */
+        size_t lower_bound(const std::vector<T> &data, const std::vector<size_t> &sorted, T value) const
+        {
+            if (count == 0 || value <= first_keys.front())
+                return 0;
+            size_t s = static_cast<size_t>(std::upper_bound(first_keys.begin(), first_keys.end(), value) - first_keys.begin()) - 1;
+            double predicted = static_cast<double>(first_pos[s]) + slopes[s] * span(value, first_keys[s]);
+            size_t guess = predicted >= static_cast<double>(count) ? count : static_cast<size_t>(predicted);
+
+            auto key = [&](size_t i)
+            { return data[sorted[i]]; };
+            size_t lo = guess > epsilon ? guess - epsilon : 0;
+            size_t hi = std::min(count, guess + epsilon + 1);
+            for (size_t step = epsilon + 1; lo > 0 && !(key(lo - 1) < value); step *= 2)
+                lo = lo > step ? lo - step : 0;
+            for (size_t step = epsilon + 1; hi < count && key(hi) < value; step *= 2)
+                hi = std::min(count, hi + step);
+
+            return static_cast<size_t>(std::lower_bound(sorted.begin() + lo, sorted.begin() + hi, value,
+                                                        [&](size_t i, T v)
+                                                        { return data[i] < v; }) -
+                                       sorted.begin());
+        }
+
+        /**
+         * @brief Returns the position in ascending order of the first key greater than value (count if none).
+         *
+         * @param data The elements the model was fitted to.
+         * @param sorted Their ascending permutation.
+         * @param value The value to search for.
+         */
+        size_t upper_bound(const std::vector<T> &data, const std::vector<size_t> &sorted, T value) const
+        {
+            if (value == std::numeric_limits<T>::max())
+                return count;
+            return lower_bound(data, sorted, static_cast<T>(value + 1));
+        }
+    };
+
+}
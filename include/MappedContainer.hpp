@@ -0,0 +1,460 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ExternalSort.hpp"
+#include "Trace.hpp"
+
+namespace containers
+{
+
+    /**
+     * @brief Access-pattern hints forwarded to madvise().
+     */
+    enum class AccessPattern
+    {
+        Normal,     // MADV_NORMAL: default kernel read-ahead.
+        Sequential, // MADV_SEQUENTIAL: aggressive read-ahead, pages dropped soon after use.
+        Random,     // MADV_RANDOM: no read-ahead.
+        WillNeed    // MADV_WILLNEED: start paging the whole mapping in now.
+    };
+
+    /**
+     * @brief A MyContainer-like container whose elements live in a memory-mapped file.
+     *
+     * The data is never copied into the heap: Regular and Reverse iteration walk the mapping and
+     * are served from the page cache, so datasets larger than RAM can be traversed. Ascending and
+     * Descending use an external merge sort bounded by a memory budget. Element count
+     * and data are kept in the file, so reopening the same path restores the container after a
+     * restart. Only trivially copyable element types are supported.
+     *
+     * File layout: a 64-byte header (magic, format, element size, count, capacity) followed by
+     * `capacity` raw elements.
+     *
+     * @tparam T The type of elements stored in the container (must be trivially copyable).
+     */
+    template <typename T = int>
+    class MappedContainer
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "MappedContainer requires a trivially copyable type");
+
+    private:
+        /**
+         * @brief On-disk header, padded to 64 bytes so the data that follows stays aligned.
+         */
+        struct Header
+        {
+            char magic[8];      // "MYCMAP" followed by zeros.
+            uint32_t format;    // File format version.
+            uint32_t elem_size; // sizeof(T) of the writer.
+            uint64_t count;     // Number of stored elements.
+            uint64_t capacity;  // Number of elements the file has room for.
+            char reserved[32];  // Pads the header to 64 bytes.
+        };
+        static_assert(sizeof(Header) == 64, "MappedContainer header must be 64 bytes");
+
+        static constexpr char MAGIC[8] = {'M', 'Y', 'C', 'M', 'A', 'P', 0, 0};
+        static constexpr uint32_t FORMAT = 1;
+        static constexpr uint64_t INITIAL_CAPACITY = 1024;
+        static constexpr size_t DEFAULT_SORT_BUDGET = size_t(64) << 20; // 64 MiB per external sort.
+
+        int fd = -1;               // Descriptor of the backing file.
+        void *base = nullptr;      // Start of the mapping (the header).
+        size_t mapped_bytes = 0;   // Length of the mapping.
+        size_t index = 0;          // Version counter to detect modifications during iteration.
+        AccessPattern pattern;     // Current madvise hint, re-applied after remapping.
+
+        Header &header() const { return *static_cast<Header *>(base); }
+        T *elements() const { return reinterpret_cast<T *>(static_cast<char *>(base) + sizeof(Header)); }
+
+        static size_t bytes_for(uint64_t capacity) { return sizeof(Header) + capacity * sizeof(T); }
+
+        /**
+         * @brief Largest capacity whose byte size bytes_for() can represent.
+         */
+        static constexpr uint64_t MAX_CAPACITY = (std::numeric_limits<size_t>::max() - sizeof(Header)) / sizeof(T);
+
+        /**
+         * @brief Tells whether an existing file's header is usable: right format and element
+         * size, a non-zero capacity that fits in the mapping, and count within capacity.
+         */
+        static bool valid_header(const Header &h, size_t mapped_bytes)
+        {
+            return std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.format == FORMAT &&
+                   h.elem_size == sizeof(T) && h.capacity > 0 && h.capacity <= MAX_CAPACITY &&
+                   bytes_for(h.capacity) <= mapped_bytes && h.count <= h.capacity;
+        }
+
+        /**
+         * @brief Throws std::runtime_error with errno's description appended, closing
+         * fd_to_close first (if not -1) without letting close() overwrite errno.
+         */
+        [[noreturn]] static void fail(const std::string &what, int fd_to_close = -1)
+        {
+            int saved = errno;
+            if (fd_to_close >= 0)
+                ::close(fd_to_close);
+            throw std::runtime_error(what + ": " + std::strerror(saved));
+        }
+
+        /**
+         * @brief Grows the file and the mapping to hold at least `needed` elements (capacity doubles).
+         */
+        void reserve_for(uint64_t needed)
+        {
+            uint64_t capacity = header().capacity;
+            if (needed <= capacity)
+                return;
+            if (needed > MAX_CAPACITY)
+                throw std::length_error("MappedContainer capacity exceeded");
+            while (capacity < needed)
+                capacity = std::min(capacity * 2, MAX_CAPACITY);
+            size_t new_bytes = bytes_for(capacity);
+            if (::ftruncate(fd, static_cast<off_t>(new_bytes)) != 0)
+                fail("Failed to grow mapped file");
+            void *moved = ::mremap(base, mapped_bytes, new_bytes, MREMAP_MAYMOVE);
+            if (moved == MAP_FAILED)
+                fail("Failed to remap file");
+            base = moved;
+            mapped_bytes = new_bytes;
+            header().capacity = capacity;
+            advise(pattern);
+        }
+
+    public:
+        /**
+         * @brief Iterator over the mapping in insertion or reverse-insertion order.
+         *
+         * Mirrors AbstractIterator's safety rules: throws if the container was modified after
+         * the iterator was created, or when dereferenced/incremented past the end.
+         */
+        class Iterator
+        {
+        private:
+            const MappedContainer *container; // The container being iterated.
+            size_t current;                   // Number of elements already visited.
+            size_t expected_index;            // Container version at creation time.
+            bool reverse;                     // Walk from the back when true.
+
+            /**
+             * @brief Throws if the container changed or the iterator is past the end.
+             */
+            void check() const
+            {
+                if (expected_index != container->index)
+                {
+                    throw std::runtime_error("Container was modified during iteration");
+                }
+                if (current >= container->size())
+                {
+                    throw std::out_of_range("Iterator out of bounds");
+                }
+            }
+
+        public:
+            /**
+             * @brief Constructs an iterator at position pos of the given direction.
+             *
+             * @param cont The container to iterate over.
+             * @param pos Number of elements already visited (size() for the end iterator).
+             * @param rev If true, walks from the last element to the first.
+             */
+            Iterator(const MappedContainer &cont, size_t pos, bool rev)
+                : container(&cont), current(pos), expected_index(cont.index), reverse(rev) {}
+
+            /**
+             * @brief Dereference operator to access the current element.
+             *
+             * @return const T& Reference into the mapping.
+             * @throws std::runtime_error If the container was modified during iteration.
+             * @throws std::out_of_range If the iterator is out of bounds.
+             */
+            const T &operator*() const
+            {
+                check();
+                size_t n = container->size();
+                return container->elements()[reverse ? n - 1 - current : current];
+            }
+
+            /**
+             * @brief Prefix increment operator to advance to the next element.
+             *
+             * @return Iterator& Reference to this iterator.
+             * @throws std::runtime_error If the container was modified during iteration.
+             * @throws std::out_of_range If the iterator is out of bounds.
+             */
+            Iterator &operator++()
+            {
+                check();
+                ++current;
+                return *this;
+            }
+
+            /**
+             * @brief Equality operator: same container, same direction, same position.
+             */
+            bool operator==(const Iterator &other) const
+            {
+                return current == other.current && reverse == other.reverse && container == other.container;
+            }
+
+            /**
+             * @brief Inequality operator.
+             */
+            bool operator!=(const Iterator &other) const { return !(*this == other); }
+        };
+
+        /**
+         * @brief Iterable wrapper returned by Regular() and Reverse().
+         */
+        class Range
+        {
+        private:
+            const MappedContainer &container; // Reference to the container being iterated.
+            bool reverse;                     // Direction of iteration.
+
+        public:
+            /**
+             * @brief Constructs a range over the container in the given direction.
+             */
+            Range(const MappedContainer &cont, bool rev) : container(cont), reverse(rev) {}
+
+            /**
+             * @brief Returns an iterator pointing to the first element of the range.
+             */
+            Iterator begin() const { return Iterator(container, 0, reverse); }
+
+            /**
+             * @brief Returns an iterator pointing past the last element of the range.
+             */
+            Iterator end() const { return Iterator(container, container.size(), reverse); }
+        };
+
+        /**
+         * @brief Opens (or creates) the container stored at path.
+         *
+         * @param path Backing file; created with an empty container if it does not exist.
+         * @param hint Initial access-pattern hint for the mapping.
+         * @throws std::runtime_error if the file cannot be opened, was written for another element size or has a corrupt header.
+         */
+        explicit MappedContainer(const std::string &path, AccessPattern hint = AccessPattern::Sequential)
+            : pattern(hint)
+        {
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0)
+                fail("Failed to open mapped file " + path);
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+                fail("Failed to stat mapped file " + path, fd);
+
+            bool fresh = st.st_size == 0;
+            if (fresh && ::ftruncate(fd, static_cast<off_t>(bytes_for(INITIAL_CAPACITY))) != 0)
+                fail("Failed to size mapped file " + path, fd);
+            mapped_bytes = fresh ? bytes_for(INITIAL_CAPACITY) : static_cast<size_t>(st.st_size);
+            if (mapped_bytes < sizeof(Header))
+            {
+                ::close(fd);
+                throw std::runtime_error("Not a MappedContainer file: " + path);
+            }
+
+            base = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED)
+                fail("Failed to map file " + path, fd);
+
+            if (fresh)
+            {
+                Header &h = header();
+                std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+                h.format = FORMAT;
+                h.elem_size = sizeof(T);
+                h.count = 0;
+                h.capacity = INITIAL_CAPACITY;
+            }
+            else if (!valid_header(header(), mapped_bytes))
+            {
+                ::munmap(base, mapped_bytes);
+                ::close(fd);
+                throw std::runtime_error("Not a MappedContainer file for this element type: " + path);
+            }
+            advise(pattern);
+        }
+
+        MappedContainer(const MappedContainer &) = delete;
+        MappedContainer &operator=(const MappedContainer &) = delete;
+
+        /**
+         * @brief Unmaps and closes the file; the contents stay on disk.
+         */
+        ~MappedContainer()
+        {
+            if (base && base != MAP_FAILED)
+                ::munmap(base, mapped_bytes);
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        /**
+         * @brief Appends an element, growing the file when needed.
+         *
+         * @param value The value to be added.
+         */
+        void add(const T &value)
+        {
+            uint64_t n = header().count;
+            reserve_for(n + 1);
+            elements()[n] = value;
+            header().count = n + 1;
+            ++index;
+        }
+
+        /**
+         * @brief Removes every element equal to value, compacting the file in place.
+         *
+         * @param value The value to be removed.
+         * @throws std::runtime_error if element is not found.
+         */
+        void remove(const T &value)
+        {
+            T *first = elements();
+            T *last = first + header().count;
+            trace::Scope trace_scope("MappedContainer::remove", "compaction", header().count);
+            T *kept = std::remove(first, last, value);
+            if (kept == last)
+            {
+                throw std::runtime_error("Element was not found");
+            }
+            header().count = static_cast<uint64_t>(kept - first);
+            ++index;
+        }
+
+        /**
+         * @brief Returns the number of elements in the container.
+         *
+         * @return size_t Number of elements.
+         */
+        size_t size() const
+        {
+            return static_cast<size_t>(header().count);
+        }
+
+        /**
+         * @brief Returns the container's version counter.
+         *
+         * @return size_t Current version.
+         */
+        size_t version() const
+        {
+            return index;
+        }
+
+        /**
+         * @brief Returns a pointer to the first element inside the mapping.
+         *
+         * Invalidated by add(), which may move the mapping.
+         *
+         * @return const T* Pointer to size() contiguous elements.
+         */
+        const T *data() const
+        {
+            return elements();
+        }
+
+        /**
+         * @brief Applies an madvise() hint to the whole mapping.
+         *
+         * @param hint Sequential for scans, Random for point lookups, WillNeed to prefetch.
+         */
+        void advise(AccessPattern hint)
+        {
+            pattern = hint;
+            int advice = MADV_NORMAL;
+            switch (hint)
+            {
+            case AccessPattern::Normal:
+                advice = MADV_NORMAL;
+                break;
+            case AccessPattern::Sequential:
+                advice = MADV_SEQUENTIAL;
+                break;
+            case AccessPattern::Random:
+                advice = MADV_RANDOM;
+                break;
+            case AccessPattern::WillNeed:
+                advice = MADV_WILLNEED;
+                break;
+            }
+            ::madvise(base, mapped_bytes, advice); // Purely advisory; failure is harmless.
+        }
+
+        /**
+         * @brief Flushes dirty pages and the header to disk.
+         *
+         * @throws std::runtime_error if msync fails.
+         */
+        void sync() const
+        {
+            if (::msync(base, mapped_bytes, MS_SYNC) != 0)
+                fail("Failed to sync mapped file");
+        }
+
+        /**
+         * @brief Returns an iterable object for regular insertion order iteration.
+         *
+         * @return Range Iterator wrapper.
+         */
+        Range Regular() const
+        {
+            return Range(*this, false);
+        }
+
+        /**
+         * @brief Returns an iterable object for reverse insertion order iteration.
+         *
+         * @return Range Iterator wrapper.
+         */
+        Range Reverse() const
+        {
+            return Range(*this, true);
+        }
+
+        /**
+         * @brief Returns an ascending traversal computed by external merge sort.
+         *
+         * Sorted runs of at most memory_budget bytes are spilled to temporary files and merged
+         * lazily while iterating, so memory use stays bounded regardless of size(). The range
+         * is a snapshot: later modifications of the container are not reflected in it.
+         *
+         * @param memory_budget Bytes of elements the sort may keep in memory.
+         * @return ExternalSortedRange<T> Iterable sorted view.
+         */
+        ExternalSortedRange<T> Ascending(size_t memory_budget = DEFAULT_SORT_BUDGET) const
+        {
+            return ExternalSortedRange<T>(elements(), size(), memory_budget, false);
+        }
+
+        /**
+         * @brief Returns a descending traversal computed by external merge sort.
+         *
+         * @param memory_budget Bytes of elements the sort may keep in memory.
+         * @return ExternalSortedRange<T> Iterable sorted view.
+         */
+        ExternalSortedRange<T> Descending(size_t memory_budget = DEFAULT_SORT_BUDGET) const
+        {
+            return ExternalSortedRange<T>(elements(), size(), memory_budget, true);
+        }
+    };
+
+}
@@ -0,0 +1,197 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <stdexcept>
+
+#include "ContainerStats.hpp"
+
+namespace containers
+{
+    namespace metrics
+    {
+
+        /**
+         * @brief Prometheus label value of each Order.
+         */
+        constexpr const char *ORDER_NAMES[ORDER_COUNT] = {"Ascending", "Descending", "SideCross",
+                                                          "Reverse", "Regular", "MiddleOut"};
+
+        /**
+         * @brief Escapes a label value for the text exposition format.
+         */
+        inline std::string escape_label(const std::string &value)
+        {
+            std::string out;
+            for (char ch : value)
+            {
+                if (ch == '\\' || ch == '"')
+                    out += '\\';
+                if (ch == '\n')
+                {
+                    out += "\\n";
+                    continue;
+                }
+                out += ch;
+            }
+            return out;
+        }
+
+        /**
+         * @brief Named MetricsSeries shared by every container reporting under that name.
+         *
+         * Containers join a series with MyContainer::set_metrics_name() (which requires
+         * MYCONTAINER_STATS; without it nothing is reported and render() lists no series).
+         * Series outlive the containers that fed them, so counts are cumulative over the
+         * process lifetime, as Prometheus counters expect.
+         */
+        class Registry
+        {
+        private:
+            mutable std::mutex mutex;                                     // Guards series.
+            std::map<std::string, std::shared_ptr<MetricsSeries>> series; // By container name, sorted for stable output.
+
+            /**
+             * @brief Writes one histogram (buckets in seconds, then _sum and _count).
+             */
+            static void render_histogram(std::ostream &os, const char *metric, const std::string &labels,
+                                         const LatencyHistogram &h)
+            {
+                for (size_t b = 0; b < LatencyHistogram::BOUNDS; ++b)
+                    os << metric << "_bucket{" << labels << ",le=\"" << static_cast<double>(LatencyHistogram::BOUND_NS[b]) / 1e9
+                       << "\"} " << h.cumulative(b) << "\n";
+                os << metric << "_bucket{" << labels << ",le=\"+Inf\"} " << h.count() << "\n";
+                os << metric << "_sum{" << labels << "} " << static_cast<double>(h.sum()) / 1e9 << "\n";
+                os << metric << "_count{" << labels << "} " << h.count() << "\n";
+            }
+
+        public:
+            /**
+             * @brief Returns the process-wide registry.
+             */
+            static Registry &global()
+            {
+                static Registry registry;
+                return registry;
+            }
+
+            /**
+             * @brief Returns the series for name, creating it on first use.
+             *
+             * @param name Container name (the `container` label).
+             * @return std::shared_ptr<MetricsSeries> The shared series.
+             */
+            std::shared_ptr<MetricsSeries> series_for(const std::string &name)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto &slot = series[name];
+                if (!slot)
+                    slot = std::make_shared<MetricsSeries>();
+                return slot;
+            }
+
+            /**
+             * @brief Returns the aggregated counters of one name (all zero if unknown).
+             */
+            ContainerStats stats(const std::string &name) const
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = series.find(name);
+                return it == series.end() ? ContainerStats{} : it->second->totals.snapshot();
+            }
+
+            /**
+             * @brief Renders every series in Prometheus text exposition format (version 0.0.4).
+             *
+             * @return std::string The exposition text.
+             */
+            std::string render() const
+            {
+                std::map<std::string, std::shared_ptr<MetricsSeries>> copy;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    copy = series;
+                }
+
+                std::ostringstream os;
+                auto counter = [&](const char *metric, const char *help, auto value_of)
+                {
+                    os << "# HELP " << metric << " " << help << "\n# TYPE " << metric << " counter\n";
+                    for (const auto &entry : copy)
+                        os << metric << "{container=\"" << escape_label(entry.first) << "\"} "
+                           << value_of(entry.second->totals.snapshot()) << "\n";
+                };
+                counter("mycontainer_adds_total", "Elements added.", [](const ContainerStats &s)
+                        { return s.adds; });
+                counter("mycontainer_removes_total", "Successful remove() calls.", [](const ContainerStats &s)
+                        { return s.removes; });
+                counter("mycontainer_sorts_total", "Sorted permutations computed.", [](const ContainerStats &s)
+                        { return s.sorts; });
+                counter("mycontainer_sort_cache_hits_total", "Sorted-permutation requests served from the cache.",
+                        [](const ContainerStats &s)
+                        { return s.sort_cache_hits; });
+                counter("mycontainer_sort_cache_misses_total", "Sorted-permutation requests that had to sort.",
+                        [](const ContainerStats &s)
+                        { return s.sort_cache_misses; });
+                counter("mycontainer_allocated_bytes_total", "Bytes of element buffers, permutations and iterator indices allocated.",
+                        [](const ContainerStats &s)
+                        { return s.bytes_allocated; });
+                counter("mycontainer_modification_errors_total", "Iterators that detected a concurrent modification.",
+                        [](const ContainerStats &s)
+                        { return s.modification_errors; });
+
+                os << "# HELP mycontainer_iterators_total Iterators constructed.\n# TYPE mycontainer_iterators_total counter\n";
+                for (const auto &entry : copy)
+                {
+                    ContainerStats s = entry.second->totals.snapshot();
+                    for (size_t o = 0; o < ORDER_COUNT; ++o)
+                        os << "mycontainer_iterators_total{container=\"" << escape_label(entry.first) << "\",order=\""
+                           << ORDER_NAMES[o] << "\"} " << s.iterator_constructions[o] << "\n";
+                }
+
+                os << "# HELP mycontainer_iterator_build_seconds Iterator construction latency.\n"
+                   << "# TYPE mycontainer_iterator_build_seconds histogram\n";
+                for (const auto &entry : copy)
+                    for (size_t o = 0; o < ORDER_COUNT; ++o)
+                        render_histogram(os, "mycontainer_iterator_build_seconds",
+                                         "container=\"" + escape_label(entry.first) + "\",order=\"" + ORDER_NAMES[o] + "\"",
+                                         entry.second->iterator_build[o]);
+
+                os << "# HELP mycontainer_sort_seconds Sorted-permutation build latency.\n"
+                   << "# TYPE mycontainer_sort_seconds histogram\n";
+                for (const auto &entry : copy)
+                    render_histogram(os, "mycontainer_sort_seconds", "container=\"" + escape_label(entry.first) + "\"",
+                                     entry.second->sort);
+                return os.str();
+            }
+
+            /**
+             * @brief Writes render() to path atomically (temporary file + rename), so a scraper never reads a partial file.
+             *
+             * @param path Output file, e.g. a node_exporter textfile-collector path.
+             * @throws std::runtime_error if the file cannot be written.
+             */
+            void write(const std::string &path) const
+            {
+                std::string tmp = path + ".tmp";
+                {
+                    std::ofstream out(tmp, std::ios::trunc);
+                    out << render();
+                    if (!out.flush())
+                        throw std::runtime_error("Failed to write metrics file " + tmp);
+                }
+                if (std::rename(tmp.c_str(), path.c_str()) != 0)
+                {
+                    std::remove(tmp.c_str());
+                    throw std::runtime_error("Failed to publish metrics file " + path);
+                }
+            }
+        };
+
+    }
+}
@@ -5,13 +5,31 @@
 #include <stdexcept>
 #include <algorithm>
 #include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+#ifdef MYCONTAINER_STATS
+#include <chrono>
+#endif
 
+#include "ContainerStats.hpp"
+#include "Metrics.hpp"
+#include "EytzingerIndex.hpp"
+#include "LearnedIndex.hpp"
 #include "iterators/AscendingOrder.hpp"
 #include "iterators/DescendingOrder.hpp"
 #include "iterators/SideCrossOrder.hpp"
 #include "iterators/ReverseOrder.hpp"
 #include "iterators/RegularOrder.hpp"
 #include "iterators/MiddleOutOrder.hpp"
+#include "WorkStealingPool.hpp"
+#include "Reductions.hpp"
+#include "Snapshot.hpp"
+#include "Trace.hpp"
 
 namespace containers
 {
@@ -25,13 +43,378 @@ namespace containers
     class MyContainer
     {
     private:
-        std::vector<T> data;                    // Internal storage of elements.
-        size_t index = 0;                       // Version counter to detect modifications during iteration.
-        std::unordered_multiset<T> fast_lookup; // Fast lookup structure for element existence check.
+        /**
+         * @brief Shared, reference-counted storage of a container.
+         *
+         * Copies of a MyContainer share one State until one of them is mutated, at which
+         * point the writer detaches and gets its own deep copy (copy-on-write).
+         */
+        struct State
+        {
+            std::vector<T> data;                    // Internal storage of elements.
+            std::unordered_multiset<T> fast_lookup; // Fast lookup structure for element existence check.
+            bool lookup_ready = false;              // fast_lookup is built lazily by the first remove().
+            std::atomic<size_t> owners{1};          // MyContainer objects sharing this state (see detach()).
+
+            mutable std::mutex sort_mutex;                           // Guards lazy construction of sorted.
+            mutable std::shared_ptr<const std::vector<size_t>> sorted; // Cached ascending permutation of data.
+
+            mutable std::mutex order_mutex;                                         // Guards lazy construction of orders.
+            mutable std::shared_ptr<const std::vector<size_t>> orders[ORDER_COUNT]; // Cached index sequence per Order (Ascending uses sorted).
+
+            mutable std::mutex index_mutex;                                // Guards lazy construction of search_index and learned_index.
+            mutable std::shared_ptr<const EytzingerIndex<T>> search_index; // Search accelerator over sorted, if enabled.
+            mutable std::shared_ptr<const LearnedIndex<T>> learned_index;  // Learned model over sorted, if enabled.
+
+            State() = default;
+
+            /**
+             * @brief Deep-copies the elements; the cached permutations are still valid for them and are shared.
+             */
+            State(const State &other)
+                : data(other.data), fast_lookup(other.fast_lookup), lookup_ready(other.lookup_ready)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(other.sort_mutex);
+                    sorted = other.sorted;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(other.order_mutex);
+                    for (size_t i = 0; i < ORDER_COUNT; ++i)
+                        orders[i] = other.orders[i];
+                }
+                std::lock_guard<std::mutex> lock(other.index_mutex);
+                search_index = other.search_index;
+                learned_index = other.learned_index;
+            }
+        };
+
+        std::shared_ptr<State> state = std::make_shared<State>(); // Possibly shared storage.
+        size_t index = 0;                                         // Version counter to detect modifications during iteration.
+        bool search_index_enabled = false;                        // Whether sorted searches use an EytzingerIndex (see use_search_index()).
+        size_t learned_epsilon = 0;                               // Error bound of the LearnedIndex, 0 when off (see use_learned_index()).
+#ifdef MYCONTAINER_STATS
+        mutable StatsCounters counters; // Runtime statistics of this object (see stats()).
+#endif
+
+        friend class AbstractIterator<T>; // Iterators record their construction and failures in counters.
+        friend class AscendingOrder<T>;   // Range queries search the sorted permutation.
+
+        /**
+         * @brief Records the new element buffer if the last write reallocated it.
+         */
+        void record_growth(size_t old_capacity)
+        {
+#ifdef MYCONTAINER_STATS
+            if (state->data.capacity() != old_capacity)
+                counters.record_bytes(state->data.capacity() * sizeof(T));
+#else
+            (void)old_capacity;
+#endif
+        }
+
+        /**
+         * @brief Gives up this object's share of state (the pointer itself is left to the caller).
+         */
+        void release_state()
+        {
+            if (state)
+                state->owners.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        /**
+         * @brief Gives this container exclusive ownership of its state before a write.
+         *
+         * Also drops the cached permutations, which the upcoming write invalidates.
+         *
+         * Ownership is decided by State::owners rather than shared_ptr::use_count() (a relaxed
+         * load): owners are released with release semantics and read here with acquire, so when
+         * another thread has just dropped the last other copy (e.g. a reader finishing with a
+         * pinned snapshot), its reads of the state happen before the in-place writes below.
+         */
+        void detach()
+        {
+            if (state->owners.load(std::memory_order_acquire) > 1)
+            {
+                auto copy = std::make_shared<State>(*state);
+                release_state();
+                state = std::move(copy);
+#ifdef MYCONTAINER_STATS
+                counters.record_bytes(state->data.capacity() * sizeof(T));
+#endif
+            }
+            state->sorted.reset();
+            for (auto &cached : state->orders)
+                cached.reset();
+            state->search_index.reset();
+            state->learned_index.reset();
+        }
+
+        /**
+         * @brief Builds fast_lookup from data if it has not been built yet; caller owns the state.
+         */
+        void build_lookup()
+        {
+            if (state->lookup_ready)
+                return;
+            state->fast_lookup.reserve(state->data.size());
+            state->fast_lookup.insert(state->data.begin(), state->data.end());
+            state->lookup_ready = true;
+        }
+
+        /**
+         * @brief Returns the cached ascending permutation, or nullptr if none is cached.
+         */
+        std::shared_ptr<const std::vector<size_t>> cached_sorted_indices() const
+        {
+            std::lock_guard<std::mutex> lock(state->sort_mutex);
+            return state->sorted;
+        }
+
+        /**
+         * @brief Returns the search accelerator for sorted, building it on first use; nullptr unless enabled.
+         *
+         * @param sorted The ascending permutation of the current version.
+         */
+        std::shared_ptr<const EytzingerIndex<T>> search_index(const std::vector<size_t> &sorted) const
+        {
+            if (!search_index_enabled)
+                return nullptr;
+            std::lock_guard<std::mutex> lock(state->index_mutex);
+            if (!state->search_index)
+            {
+                trace::Scope trace_scope("search_index", "sort", sorted.size());
+                state->search_index = std::make_shared<const EytzingerIndex<T>>(state->data, sorted);
+#ifdef MYCONTAINER_STATS
+                counters.record_bytes(state->search_index->memory_bytes());
+#endif
+            }
+            return state->search_index;
+        }
+
+        /**
+         * @brief Returns the learned model for sorted, fitting it on first use; nullptr unless enabled.
+         *
+         * @param sorted The ascending permutation of the current version.
+         */
+        std::shared_ptr<const LearnedIndex<T>> learned_index(const std::vector<size_t> &sorted) const
+        {
+            if (learned_epsilon == 0)
+                return nullptr;
+            std::lock_guard<std::mutex> lock(state->index_mutex);
+            if (!state->learned_index || state->learned_index->error_bound() != learned_epsilon)
+            {
+                trace::Scope trace_scope("learned_index", "sort", sorted.size());
+                state->learned_index = std::make_shared<const LearnedIndex<T>>(state->data, sorted, learned_epsilon);
+#ifdef MYCONTAINER_STATS
+                counters.record_bytes(state->learned_index->memory_bytes());
+#endif
+            }
+            return state->learned_index;
+        }
+
+        /**
+         * @brief Returns the position in sorted of the first element not less than value (sorted->size() if none).
+         *
+         * @param sorted The ascending permutation of the current version.
+         * @param value The value to search for.
+         */
+        size_t sorted_lower_bound(const std::vector<size_t> &sorted, const T &value) const
+        {
+            if constexpr (learnable_key<T>)
+                if (auto model = learned_index(sorted))
+                    return model->lower_bound(state->data, sorted, value);
+            if (auto accelerator = search_index(sorted))
+                return accelerator->lower_bound(value);
+            const auto &data = state->data;
+            return static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), value,
+                                                        [&](size_t i, const T &v)
+                                                        { return data[i] < v; }) -
+                                       sorted.begin());
+        }
+
+        /**
+         * @brief Returns the position in sorted of the first element greater than value (sorted->size() if none).
+         *
+         * @param sorted The ascending permutation of the current version.
+         * @param value The value to search for.
+         */
+        size_t sorted_upper_bound(const std::vector<size_t> &sorted, const T &value) const
+        {
+            if constexpr (learnable_key<T>)
+                if (auto model = learned_index(sorted))
+                    return model->upper_bound(state->data, sorted, value);
+            if (auto accelerator = search_index(sorted))
+                return accelerator->upper_bound(value);
+            const auto &data = state->data;
+            return static_cast<size_t>(std::upper_bound(sorted.begin(), sorted.end(), value,
+                                                        [&](const T &v, size_t i)
+                                                        { return v < data[i]; }) -
+                                       sorted.begin());
+        }
+
+        /**
+         * @brief Returns the permutation as the uint64 indices a snapshot stores (nullptr if none).
+         *
+         * Points into sorted itself when size_t is uint64_t; otherwise widens into storage.
+         */
+        static const uint64_t *snapshot_indices(const std::shared_ptr<const std::vector<size_t>> &sorted,
+                                                std::vector<uint64_t> &storage)
+        {
+            if (!sorted)
+                return nullptr;
+            if constexpr (std::is_same<size_t, uint64_t>::value)
+                return sorted->data();
+            else
+            {
+                storage.assign(sorted->begin(), sorted->end());
+                return storage.data();
+            }
+        }
+
+        /**
+         * @brief Writes the snapshot file for save() and background_snapshot().
+         *
+         * Neither allocates nor throws, so a forked child may run it: failures are recorded
+         * in out (see snapshot::Writer) and reported by the return value.
+         *
+         * @param out A writer prepared for the destination path.
+         * @param sorted The ascending permutation as uint64 indices, or nullptr to omit it.
+         * @return true If the snapshot was published.
+         */
+        bool write_snapshot(snapshot::Writer &out, const uint64_t *sorted) const
+        {
+            const auto &data = get_data();
+            size_t bytes = data.size() * sizeof(T);
 
-        friend class AbstractIterator<T>; // Allows AbstractIterator to access private members.
+            snapshot::Header header{};
+            std::memcpy(header.magic, snapshot::MAGIC, sizeof(snapshot::MAGIC));
+            header.format = snapshot::FORMAT;
+            header.elem_size = sizeof(T);
+            header.count = data.size();
+            header.version = index;
+
+            if (!out.open() || !out.write(&header, sizeof(header)))
+                return false;
+            header.data_offset = out.position();
+            header.checksum = snapshot::checksum64(data.data(), bytes);
+            if (!out.write(data.data(), bytes))
+                return false;
+
+            if (sorted && !data.empty())
+            {
+                if (!out.align(alignof(uint64_t)))
+                    return false;
+                header.sorted_offset = out.position();
+                size_t sorted_bytes = data.size() * sizeof(uint64_t);
+                snapshot::SortedSection section{header.checksum, snapshot::checksum64(sorted, sorted_bytes)};
+                if (!out.write(&section, sizeof(section)) || !out.write(sorted, sorted_bytes))
+                    return false;
+            }
+            return out.patch(0, &header, sizeof(header)) && out.commit();
+        }
+
+        /**
+         * @brief Seeds the sorted cache from a snapshot's sorted section if it is valid for the loaded data.
+         */
+        void adopt_sorted_section(const snapshot::Reader &in)
+        {
+            const snapshot::Header &header = in.header();
+            uint64_t n = header.count;
+            if (header.sorted_offset == 0 || n == 0 || header.sorted_offset % alignof(uint64_t) != 0 ||
+                header.sorted_offset > in.size() ||
+                (in.size() - header.sorted_offset) < sizeof(snapshot::SortedSection) ||
+                (in.size() - header.sorted_offset - sizeof(snapshot::SortedSection)) / sizeof(uint64_t) < n)
+                return;
+
+            const auto *section = static_cast<const snapshot::SortedSection *>(in.at(header.sorted_offset));
+            const auto *perm = static_cast<const uint64_t *>(in.at(header.sorted_offset + sizeof(snapshot::SortedSection)));
+            if (section->data_checksum != header.checksum ||
+                snapshot::checksum64(perm, n * sizeof(uint64_t)) != section->checksum)
+                return;
+
+            auto sorted = std::make_shared<std::vector<size_t>>(perm, perm + n);
+            for (size_t i : *sorted)
+                if (i >= n)
+                    return;
+            state->sorted = std::move(sorted);
+        }
+
+        /**
+         * @brief Shared implementation of min() and max().
+         */
+        template <bool Less>
+        T extreme() const
+        {
+            const auto &data = get_data();
+            if (data.empty())
+            {
+                throw std::runtime_error("Container is empty");
+            }
+            return reductions::reduce<T>(
+                data.data(), data.size(),
+                [](const T *p, size_t n)
+                { return reductions::extreme_kernel<Less>(p, n); },
+                [](const T &a, const T &b)
+                { return (Less ? b < a : a < b) ? b : a; });
+        }
 
     public:
+        /**
+         * @brief Constructs an empty container.
+         */
+        MyContainer() = default;
+
+        /**
+         * @brief Copies a container in O(1) by sharing its storage (copy-on-write).
+         *
+         * The data, lookup structure and any cached sorted permutation are shared until
+         * either container is mutated.
+         *
+         * @param other The container to copy.
+         */
+        MyContainer(const MyContainer &other)
+            : state(other.state), index(other.index), search_index_enabled(other.search_index_enabled),
+              learned_epsilon(other.learned_epsilon)
+#ifdef MYCONTAINER_STATS
+              ,
+              counters(other.counters)
+#endif
+        {
+            state->owners.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Copy-assigns in O(1) by sharing storage (copy-on-write).
+         *
+         * @param other The container to copy.
+         * @return MyContainer& Reference to this container.
+         */
+        MyContainer &operator=(const MyContainer &other)
+        {
+            if (state != other.state)
+            {
+                other.state->owners.fetch_add(1, std::memory_order_relaxed);
+                release_state();
+                state = other.state;
+            }
+            index = other.index;
+            search_index_enabled = other.search_index_enabled;
+            learned_epsilon = other.learned_epsilon;
+#ifdef MYCONTAINER_STATS
+            counters = other.counters;
+#endif
+            return *this;
+        }
+
+        /**
+         * @brief Releases this object's share of the storage.
+         */
+        ~MyContainer()
+        {
+            release_state();
+        }
+
         /**
          * @brief Adds a new element to the container.
          *
@@ -39,33 +422,224 @@ namespace containers
          */
         void add(const T &value)
         {
-            data.push_back(value);
-            fast_lookup.insert(value);
+            detach();
+            size_t old_capacity = state->data.capacity();
+            state->data.push_back(value);
+            record_growth(old_capacity);
+            if (state->lookup_ready)
+                state->fast_lookup.insert(value);
+#ifdef MYCONTAINER_STATS
+            counters.record_adds(1);
+#endif
+            ++index;
+        }
+
+        /**
+         * @brief Adds a range of elements in one bulk step.
+         *
+         * Reserves space once, detaches at most once and bumps the version a single time,
+         * which makes it the preferred path for splicing buffered elements in.
+         *
+         * @tparam It Input iterator whose value type converts to T.
+         * @param first Beginning of the range.
+         * @param last End of the range.
+         */
+        template <typename It>
+        void add_all(It first, It last)
+        {
+            if (first == last)
+                return;
+            detach();
+            auto &data = state->data;
+            trace::Scope trace_scope("add_all", "mutation", data.size());
+            size_t old_size = data.size();
+            size_t old_capacity = data.capacity();
+            data.insert(data.end(), first, last);
+            record_growth(old_capacity);
+            if (state->lookup_ready)
+            {
+                state->fast_lookup.reserve(data.size());
+                state->fast_lookup.insert(data.begin() + old_size, data.end());
+            }
+#ifdef MYCONTAINER_STATS
+            counters.record_adds(data.size() - old_size);
+#endif
             ++index;
         }
 
         /**
          * @brief Removes an element from the container.
          *
-         * If the element is not found, throws std::runtime_error.
+         * If the element is not found, throws std::runtime_error. The lookup structure is
+         * built on the first call, so containers that are only appended to (or just loaded
+         * from a snapshot) never pay for it.
          *
          * @param value The value to be removed.
          * @throws std::runtime_error if element is not found.
          */
         void remove(const T &value)
         {
-            if (fast_lookup.count(value) == 0)
+            bool found = state->lookup_ready
+                             ? state->fast_lookup.count(value) != 0
+                             : std::find(state->data.begin(), state->data.end(), value) != state->data.end();
+            if (!found)
             {
                 throw std::runtime_error("Element was not found");
             }
 
+            detach();
+            build_lookup();
+            auto &data = state->data;
+            trace::Scope trace_scope("remove", "compaction", data.size());
             data.erase(std::remove(data.begin(), data.end(), value), data.end());
 
-            fast_lookup.erase(value);
+            state->fast_lookup.erase(value);
+#ifdef MYCONTAINER_STATS
+            counters.record_remove();
+#endif
 
             ++index;
         }
 
+        /**
+         * @brief Tells whether the container holds an element equal to value.
+         *
+         * Uses the hash lookup once remove() has built it, otherwise a binary search over the
+         * cached ascending permutation if there is one, otherwise a linear scan. Repeated calls
+         * do not allocate, except that the first search after a mutation builds the index
+         * enabled by use_search_index() or use_learned_index(), if any.
+         *
+         * @param value The value to look for.
+         * @return true If at least one equal element is stored.
+         */
+        bool contains(const T &value) const
+        {
+            if (state->lookup_ready)
+                return state->fast_lookup.count(value) != 0;
+            const auto &data = state->data;
+            auto sorted = cached_sorted_indices();
+            if (sorted)
+            {
+                size_t pos = sorted_lower_bound(*sorted, value);
+                return pos != sorted->size() && !(value < data[(*sorted)[pos]]);
+            }
+            return std::find(data.begin(), data.end(), value) != data.end();
+        }
+
+        /**
+         * @brief Reserves room for at least n elements, so later add() calls do not reallocate.
+         *
+         * Until the first remove() builds the hash lookup, add() after reserve() performs no
+         * allocation at all; afterwards each add() allocates one lookup node.
+         *
+         * @param n Number of elements to make room for.
+         */
+        void reserve(size_t n)
+        {
+            detach();
+            size_t old_capacity = state->data.capacity();
+            state->data.reserve(n);
+            record_growth(old_capacity);
+            if (state->lookup_ready)
+                state->fast_lookup.reserve(n);
+        }
+
+        /**
+         * @brief Writes the container to a versioned binary snapshot.
+         *
+         * The file holds a 64-byte header (magic, format, element size, count, version,
+         * section offsets, checksum) followed by the raw element bytes. It is written to
+         * `path + ".tmp"`, synced and renamed over path, so readers never see a partial file.
+         *
+         * If the ascending permutation is cached for the current version (or with_sorted is
+         * set), it is appended as a sorted section tied to the data checksum, so load() can
+         * skip the first sort after a restart.
+         *
+         * @param path Destination file.
+         * @param with_sorted Compute the permutation if it is not cached yet, so it is always persisted.
+         * @throws std::runtime_error on I/O failure.
+         */
+        void save(const std::string &path, bool with_sorted = false) const
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "save() requires a trivially copyable element type");
+            auto sorted = with_sorted ? sorted_indices() : cached_sorted_indices();
+            std::vector<uint64_t> wide;
+            snapshot::Writer out(path);
+            write_snapshot(out, snapshot_indices(sorted, wide));
+            out.check();
+        }
+
+        /**
+         * @brief Writes a snapshot from a forked child while this process keeps running.
+         *
+         * The child sees a copy-on-write image of the address space frozen at the fork, so
+         * the snapshot is consistent even if the caller mutates the container right away;
+         * only pages the parent touches afterwards get copied by the kernel. The cached
+         * sorted permutation, if any, and every path string are prepared before forking, so
+         * the child only makes system calls: it takes no lock, never allocates (another
+         * thread, e.g. of the shared pool or a WAL flusher, may have held malloc's lock at the
+         * fork) and never throws, and it reports failure through its exit status. The
+         * snapshot is published atomically (see save()).
+         *
+         * @param path Destination file.
+         * @return SnapshotJob Handle used to poll or wait for the child's result.
+         * @throws std::runtime_error if fork() fails.
+         */
+        SnapshotJob background_snapshot(const std::string &path) const
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "background_snapshot() requires a trivially copyable element type");
+            auto sorted = cached_sorted_indices();
+            std::vector<uint64_t> wide;
+            const uint64_t *indices = snapshot_indices(sorted, wide);
+            snapshot::Writer out(path);
+            std::cout.flush();
+            std::cerr.flush();
+            pid_t pid = ::fork();
+            if (pid < 0)
+            {
+                snapshot::fail("Failed to fork snapshot writer");
+            }
+            if (pid == 0)
+            {
+                bool published = write_snapshot(out, indices);
+                if (!published)
+                    out.abandon();
+                ::_exit(published ? 0 : 1);
+            }
+            return SnapshotJob(pid, path);
+        }
+
+        /**
+         * @brief Loads a container written by save().
+         *
+         * The file is mapped and its element section copied into the container in a single
+         * bulk copy after the checksum is verified; nothing is parsed per element. A persisted
+         * sorted section whose data checksum matches seeds the sorted cache, so the first
+         * Ascending/Descending/SideCross after a restart does not sort. A stale or damaged
+         * section is ignored.
+         *
+         * @param path Snapshot file.
+         * @return MyContainer<T> The loaded container, at the version it was saved with.
+         * @throws std::runtime_error if the file is missing, incompatible or corrupt.
+         */
+        static MyContainer load(const std::string &path)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "load() requires a trivially copyable element type");
+            snapshot::Reader in(path, sizeof(T));
+            const snapshot::Header &header = in.header();
+            const T *first = static_cast<const T *>(in.at(header.data_offset));
+            if (snapshot::checksum64(first, header.count * sizeof(T)) != header.checksum)
+            {
+                throw std::runtime_error("Snapshot checksum mismatch: " + path);
+            }
+
+            MyContainer loaded;
+            loaded.state->data.assign(first, first + header.count);
+            loaded.index = header.version;
+            loaded.adopt_sorted_section(in);
+            return loaded;
+        }
+
         /**
          * @brief Returns the number of elements in the container.
          *
@@ -73,7 +647,106 @@ namespace containers
          */
         size_t size() const
         {
-            return data.size();
+            return state->data.size();
+        }
+
+        /**
+         * @brief Returns the container's version counter.
+         *
+         * The counter is bumped by every mutation of this object, so if version() returns the
+         * same value twice for the same object, its elements did not change in between. A copy
+         * starts at the version of its source and then counts on its own, so equal versions of
+         * different objects say nothing about their contents.
+         *
+         * @return size_t Current version.
+         */
+        size_t version() const
+        {
+            return index;
+        }
+
+        /**
+         * @brief Returns this container's runtime statistics.
+         *
+         * Counting is opt-in: define MYCONTAINER_STATS before including this header. Without
+         * it the counters are compiled out and the result is all zeros (ContainerStats::enabled
+         * is false). Counters belong to this object; copies start from zero.
+         *
+         * @return ContainerStats Snapshot of the counters.
+         */
+        ContainerStats stats() const
+        {
+#ifdef MYCONTAINER_STATS
+            return counters.snapshot();
+#else
+            return ContainerStats{};
+#endif
+        }
+
+        /**
+         * @brief Zeroes the runtime statistics (no-op when they are compiled out).
+         */
+        void reset_stats() const
+        {
+#ifdef MYCONTAINER_STATS
+            counters.reset();
+#endif
+        }
+
+        /**
+         * @brief Makes this container (and copies made from it afterwards) report into a named metrics series.
+         *
+         * Containers given the same name are aggregated; the registry renders them in
+         * Prometheus text format with `container="<name>"` labels and also keeps iterator
+         * build and sort latency histograms. No-op unless MYCONTAINER_STATS is defined.
+         *
+         * @param name The series name.
+         * @param registry The registry to report into (defaults to metrics::Registry::global()).
+         */
+        void set_metrics_name(const std::string &name, metrics::Registry &registry = metrics::Registry::global())
+        {
+#ifdef MYCONTAINER_STATS
+            counters.attach(registry.series_for(name));
+#else
+            (void)name;
+            (void)registry;
+#endif
+        }
+
+        /**
+         * @brief Turns the cache-friendly search accelerator for sorted lookups on or off.
+         *
+         * When on, contains(), rank() and the Ascending() range queries search an
+         * EytzingerIndex (a copy of the sorted keys in BFS layout) instead of binary-searching
+         * the permutation, which avoids a cache miss per level and the indirection into the
+         * data. The index is built on the first search after each mutation and shared by
+         * copies, so it pays off for read-mostly containers; it costs sizeof(T) + sizeof(size_t)
+         * bytes per element. Results are identical either way.
+         *
+         * @param enabled Whether searches use the accelerator.
+         */
+        void use_search_index(bool enabled = true)
+        {
+            search_index_enabled = enabled;
+        }
+
+        /**
+         * @brief Turns the learned index for sorted lookups on (epsilon > 0) or off (epsilon == 0).
+         *
+         * Integral element types only. When on, contains(), rank() and the Ascending() range
+         * queries predict the answer's position with a piecewise linear model of the sorted
+         * keys (see LearnedIndex) and search only about 2 * epsilon positions around it. The
+         * model is fitted on the first search after each mutation and shared by copies; for
+         * regular keys (timestamps, sequential ids) it takes a few segments, a small fraction of
+         * a B-tree's memory. It takes precedence over use_search_index(). Results are identical
+         * either way.
+         *
+         * @param epsilon Maximum position error of the model; smaller means more segments and shorter final searches.
+         */
+        void use_learned_index(size_t epsilon = 32)
+        {
+            static_assert(learnable_key<T>, "use_learned_index() requires an integral element type");
+            learned_epsilon = epsilon;
         }
 
         /**
@@ -86,10 +759,11 @@ namespace containers
         friend std::ostream &operator<<(std::ostream &os, const MyContainer<T> &container)
         {
             os << "[";
-            for (size_t i = 0; i < container.data.size(); ++i)
+            const auto &data = container.get_data();
+            for (size_t i = 0; i < data.size(); ++i)
             {
-                os << container.data[i];
-                if (i < container.data.size() - 1)
+                os << data[i];
+                if (i < data.size() - 1)
                     os << ", ";
             }
             os << "]";
@@ -103,7 +777,315 @@ namespace containers
          */
         const std::vector<T> &get_data() const
         {
-            return data;
+            return state->data;
+        }
+
+        /**
+         * @brief Tells whether the ascending permutation is already cached for the current version.
+         *
+         * @return true If the next sorted iteration will not sort.
+         */
+        bool sorted_cached() const
+        {
+            return cached_sorted_indices() != nullptr;
+        }
+
+        /**
+         * @brief Returns the permutation of indices that sorts the data in ascending order.
+         *
+         * The permutation is computed once per version and cached in the (shared) state,
+         * so Ascending, Descending and SideCross iterations and copies of this container
+         * reuse a single sort.
+         *
+         * @return std::shared_ptr<const std::vector<size_t>> Indices into get_data(), ascending by value.
+         */
+        std::shared_ptr<const std::vector<size_t>> sorted_indices() const
+        {
+            std::lock_guard<std::mutex> lock(state->sort_mutex);
+#ifdef MYCONTAINER_STATS
+            counters.record_cache(state->sorted != nullptr);
+            auto sort_start = std::chrono::steady_clock::now();
+#endif
+            if (!state->sorted)
+            {
+                const auto &data = state->data;
+                trace::Scope trace_scope("sort", "sort", data.size());
+                auto perm = std::make_shared<std::vector<size_t>>(data.size());
+                for (size_t i = 0; i < data.size(); ++i)
+                    (*perm)[i] = i;
+
+                std::sort(perm->begin(), perm->end(),
+                          [&](size_t a, size_t b)
+                          {
+                              return data[a] < data[b];
+                          });
+                state->sorted = std::move(perm);
+#ifdef MYCONTAINER_STATS
+                counters.record_sort(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                               std::chrono::steady_clock::now() - sort_start)
+                                                               .count()));
+                counters.record_bytes(data.size() * sizeof(size_t));
+#endif
+            }
+            return state->sorted;
+        }
+
+        /**
+         * @brief Returns the indices into get_data() visited by the given order.
+         *
+         * @param order The iteration order.
+         * @return std::vector<size_t> Indices in iteration order.
+         */
+        std::vector<size_t> order_indices(Order order) const
+        {
+            switch (order)
+            {
+            case Order::Ascending:
+                return AscendingOrder<T>::build_indices(*this);
+            case Order::Descending:
+                return DescendingOrder<T>::build_indices(*this);
+            case Order::SideCross:
+                return SideCrossOrder<T>::build_indices(*this);
+            case Order::Reverse:
+                return ReverseOrder<T>::build_indices(*this);
+            case Order::Regular:
+                return RegularOrder<T>::build_indices(*this);
+            case Order::MiddleOut:
+                return MiddleOutOrder<T>::build_indices(*this);
+            }
+            throw std::invalid_argument("Unknown iteration order");
+        }
+
+        /**
+         * @brief Returns the indices visited by the given order, cached per version and shared.
+         *
+         * Each order's index sequence is built on first use and kept in the (shared) state
+         * until the next mutation; Ascending reuses sorted_indices() directly. Iterators hold
+         * the returned pointer, so iterating an unchanged container allocates nothing.
+         *
+         * @param order The iteration order.
+         * @return std::shared_ptr<const std::vector<size_t>> Indices into get_data(), in iteration order.
+         */
+        std::shared_ptr<const std::vector<size_t>> order_permutation(Order order) const
+        {
+            if (order == Order::Ascending)
+                return sorted_indices();
+            std::lock_guard<std::mutex> lock(state->order_mutex);
+            auto &cached = state->orders[static_cast<size_t>(order)];
+            if (!cached)
+            {
+                cached = std::make_shared<const std::vector<size_t>>(order_indices(order));
+#ifdef MYCONTAINER_STATS
+                counters.record_bytes(cached->size() * sizeof(size_t));
+#endif
+            }
+            return cached;
+        }
+
+        /**
+         * @brief Applies fn to every element on a work-stealing thread pool.
+         *
+         * The index sequence of the requested order is split into chunks that the pool's
+         * workers process concurrently, so fn must be safe to call from several threads.
+         * Elements are visited exactly once, but not in order. The container must not be
+         * modified until the call returns.
+         *
+         * @param order The iteration order whose elements are visited.
+         * @param fn Callable invoked as fn(const T&).
+         * @param pool The pool to run on (defaults to WorkStealingPool::shared()).
+         * @throws Rethrows the first exception thrown by fn.
+         */
+        template <typename Fn>
+        void parallel_for_each(Order order, Fn fn, WorkStealingPool &pool = WorkStealingPool::shared()) const
+        {
+            const auto indices = order_permutation(order);
+            const auto &data = get_data();
+            pool.parallel_for(indices->size(), [&](size_t begin, size_t end)
+                              {
+                                  for (size_t i = begin; i < end; ++i)
+                                      fn(data[(*indices)[i]]); });
+        }
+
+        /**
+         * @brief Sums all elements directly over the contiguous buffer.
+         *
+         * Uses AVX2 kernels for int, float and double when the CPU supports AVX2 (checked at
+         * run time), a scalar multi-accumulator loop otherwise, and splits across the shared pool for large buffers.
+         * Integers are summed in 64 bits.
+         *
+         * @return reductions::sum_t<T> The sum (T{} for an empty container).
+         */
+        reductions::sum_t<T> sum() const
+        {
+            const auto &data = get_data();
+            if (data.empty())
+                return reductions::sum_t<T>{};
+            return reductions::reduce<reductions::sum_t<T>>(
+                data.data(), data.size(),
+                [](const T *p, size_t n)
+                { return reductions::sum_kernel(p, n); },
+                [](const reductions::sum_t<T> &a, const reductions::sum_t<T> &b)
+                { return a + b; });
+        }
+
+        /**
+         * @brief Returns the smallest element.
+         *
+         * @return T The minimum.
+         * @throws std::runtime_error if the container is empty.
+         */
+        T min() const
+        {
+            return extreme<true>();
+        }
+
+        /**
+         * @brief Returns the largest element.
+         *
+         * @return T The maximum.
+         * @throws std::runtime_error if the container is empty.
+         */
+        T max() const
+        {
+            return extreme<false>();
+        }
+
+        /**
+         * @brief Returns the arithmetic mean of the elements.
+         *
+         * @return double The mean.
+         * @throws std::runtime_error if the container is empty.
+         */
+        double mean() const
+        {
+            static_assert(std::is_arithmetic<T>::value, "mean() requires an arithmetic element type");
+            if (size() == 0)
+            {
+                throw std::runtime_error("Container is empty");
+            }
+            return static_cast<double>(sum()) / static_cast<double>(size());
+        }
+
+        /**
+         * @brief Counts the elements that satisfy a predicate.
+         *
+         * For large buffers pred is called from several threads concurrently.
+         *
+         * @param pred Callable invoked as pred(const T&) returning bool.
+         * @return size_t Number of matching elements.
+         */
+        template <typename Pred>
+        size_t count_if(Pred pred) const
+        {
+            const auto &data = get_data();
+            if (data.empty())
+                return 0;
+            return reductions::reduce<size_t>(
+                data.data(), data.size(),
+                [&](const T *p, size_t n)
+                { return reductions::count_kernel(p, n, pred); },
+                [](size_t a, size_t b)
+                { return a + b; });
+        }
+
+        /**
+         * @brief Returns the k-th smallest element (k = 0 is the minimum).
+         *
+         * O(1) when the ascending permutation is cached. Otherwise a selection
+         * (std::nth_element, expected O(n)) runs on a scratch copy, leaving the container
+         * and its cache untouched; small trivially copyable elements are copied directly,
+         * others are selected through an index array so no element is copied.
+         *
+         * @param k Zero-based rank.
+         * @return T The element.
+         * @throws std::out_of_range if k >= size().
+         */
+        T nth(size_t k) const
+        {
+            const auto &data = get_data();
+            if (k >= data.size())
+            {
+                throw std::out_of_range("Rank out of range");
+            }
+            if (auto sorted = cached_sorted_indices())
+                return data[(*sorted)[k]];
+            if constexpr (std::is_trivially_copyable<T>::value && sizeof(T) <= sizeof(size_t))
+            {
+                std::vector<T> scratch(data);
+                std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+                return scratch[k];
+            }
+            else
+            {
+                std::vector<size_t> scratch(data.size());
+                for (size_t i = 0; i < scratch.size(); ++i)
+                    scratch[i] = i;
+                std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end(),
+                                 [&](size_t a, size_t b)
+                                 { return data[a] < data[b]; });
+                return data[scratch[k]];
+            }
+        }
+
+        /**
+         * @brief Returns the number of elements strictly less than value.
+         *
+         * O(log n) binary search over the cached ascending permutation, or one O(n) pass
+         * (no allocation, no sort) when none is cached.
+         *
+         * @param value The value to rank.
+         * @return size_t Count of elements < value.
+         */
+        size_t rank(const T &value) const
+        {
+            if (auto sorted = cached_sorted_indices())
+                return sorted_lower_bound(*sorted, value);
+            return count_if([&](const T &x)
+                            { return x < value; });
+        }
+
+        /**
+         * @brief Returns the p-th percentile using the nearest-rank method.
+         *
+         * The result is the smallest element such that at least p% of the elements are less
+         * than or equal to it (p = 0 gives the minimum, p = 100 the maximum). Same cost as nth().
+         *
+         * @param p Percentile in [0, 100].
+         * @return T The element.
+         * @throws std::invalid_argument if p is outside [0, 100].
+         * @throws std::runtime_error if the container is empty.
+         */
+        T percentile(double p) const
+        {
+            if (!(p >= 0.0 && p <= 100.0))
+            {
+                throw std::invalid_argument("Percentile must be within [0, 100]");
+            }
+            size_t n = size();
+            if (n == 0)
+            {
+                throw std::runtime_error("Container is empty");
+            }
+            double rank = std::ceil(p / 100.0 * static_cast<double>(n));
+            size_t k = rank < 1.0 ? 0 : static_cast<size_t>(rank) - 1;
+            return nth(std::min(k, n - 1));
+        }
+
+        /**
+         * @brief Returns the lower median, nth((size() - 1) / 2).
+         *
+         * Works for any ordered T (no averaging); same cost as nth().
+         *
+         * @return T The median element.
+         * @throws std::runtime_error if the container is empty.
+         */
+        T median() const
+        {
+            if (size() == 0)
+            {
+                throw std::runtime_error("Container is empty");
+            }
+            return nth((size() - 1) / 2);
         }
 
         /**
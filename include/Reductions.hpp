@@ -0,0 +1,332 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "WorkStealingPool.hpp"
+
+// AVX2 kernels are compiled on x86-64 with GCC or Clang whatever the -m flags, via the
+// target attribute, and selected at run time when the CPU supports AVX2.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MYCONTAINER_AVX2_KERNELS 1
+#define MYCONTAINER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace containers
+{
+    namespace reductions
+    {
+
+        /**
+         * @brief Accumulator type of sum(): 64-bit for integers (so sums of int do not overflow
+         * after a few thousand elements), T itself otherwise.
+         */
+        template <typename T, typename = void>
+        struct SumType
+        {
+            using type = T;
+        };
+
+        template <typename T>
+        struct SumType<T, std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>>>
+        {
+            using type = long long;
+        };
+
+        template <typename T>
+        struct SumType<T, std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T>>>
+        {
+            using type = unsigned long long;
+        };
+
+        template <typename T>
+        using sum_t = typename SumType<T>::type;
+
+        /**
+         * @brief Buffers at least this long are split across the shared WorkStealingPool.
+         */
+        constexpr size_t parallel_threshold = size_t(1) << 20;
+
+        /**
+         * @brief Sums n elements; four independent accumulators keep the loop free of a single dependency chain.
+         */
+        template <typename T>
+        sum_t<T> sum_scalar(const T *p, size_t n)
+        {
+            if constexpr (!std::is_arithmetic_v<T>)
+            {
+                // Non-numeric sums (e.g. string concatenation) must keep element order.
+                sum_t<T> total{};
+                for (size_t i = 0; i < n; ++i)
+                    total = total + p[i];
+                return total;
+            }
+            else
+            {
+                sum_t<T> a0{}, a1{}, a2{}, a3{};
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                {
+                    a0 = a0 + p[i];
+                    a1 = a1 + p[i + 1];
+                    a2 = a2 + p[i + 2];
+                    a3 = a3 + p[i + 3];
+                }
+                for (; i < n; ++i)
+                    a0 = a0 + p[i];
+                return (a0 + a1) + (a2 + a3);
+            }
+        }
+
+        /**
+         * @brief Returns the smallest (Less = true) or largest element of a non-empty buffer.
+         */
+        template <bool Less, typename T>
+        T extreme_scalar(const T *p, size_t n)
+        {
+            T best = p[0];
+            for (size_t i = 1; i < n; ++i)
+                if (Less ? p[i] < best : best < p[i])
+                    best = p[i];
+            return best;
+        }
+
+#if defined(MYCONTAINER_AVX2_KERNELS)
+        /**
+         * @brief Tells whether the CPU running the program supports AVX2 (checked once).
+         */
+        inline bool avx2_available()
+        {
+#if defined(__AVX2__)
+            return true;
+#else
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+#endif
+        }
+
+        /**
+         * @brief AVX2 sum of int32 elements, widened to 64-bit lanes.
+         */
+        MYCONTAINER_AVX2_TARGET inline long long sum_avx2(const int32_t *p, size_t n)
+        {
+            __m256i acc = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+            }
+            alignas(32) long long lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+            long long total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            for (; i < n; ++i)
+                total += p[i];
+            return total;
+        }
+
+        /**
+         * @brief AVX2 sum of doubles with two vector accumulators.
+         */
+        MYCONTAINER_AVX2_TARGET inline double sum_avx2(const double *p, size_t n)
+        {
+            __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                a0 = _mm256_add_pd(a0, _mm256_loadu_pd(p + i));
+                a1 = _mm256_add_pd(a1, _mm256_loadu_pd(p + i + 4));
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, _mm256_add_pd(a0, a1));
+            double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            for (; i < n; ++i)
+                total += p[i];
+            return total;
+        }
+
+        /**
+         * @brief AVX2 sum of floats with two vector accumulators.
+         */
+        MYCONTAINER_AVX2_TARGET inline float sum_avx2(const float *p, size_t n)
+        {
+            __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                a0 = _mm256_add_ps(a0, _mm256_loadu_ps(p + i));
+                a1 = _mm256_add_ps(a1, _mm256_loadu_ps(p + i + 8));
+            }
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, _mm256_add_ps(a0, a1));
+            float total = 0;
+            for (float lane : lanes)
+                total += lane;
+            for (; i < n; ++i)
+                total += p[i];
+            return total;
+        }
+
+        /**
+         * @brief AVX2 minimum (Less = true) or maximum of a non-empty int32 buffer.
+         */
+        template <bool Less>
+        MYCONTAINER_AVX2_TARGET int32_t extreme_avx2(const int32_t *p, size_t n)
+        {
+            if (n < 8)
+                return extreme_scalar<Less>(p, n);
+            __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            size_t i = 8;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+                acc = Less ? _mm256_min_epi32(acc, v) : _mm256_max_epi32(acc, v);
+            }
+            alignas(32) int32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+            int32_t best = extreme_scalar<Less>(lanes, 8);
+            for (; i < n; ++i)
+                if (Less ? p[i] < best : best < p[i])
+                    best = p[i];
+            return best;
+        }
+
+        /**
+         * @brief AVX2 minimum (Less = true) or maximum of a non-empty double buffer.
+         */
+        template <bool Less>
+        MYCONTAINER_AVX2_TARGET double extreme_avx2(const double *p, size_t n)
+        {
+            if (n < 4)
+                return extreme_scalar<Less>(p, n);
+            __m256d acc = _mm256_loadu_pd(p);
+            size_t i = 4;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256d v = _mm256_loadu_pd(p + i);
+                acc = Less ? _mm256_min_pd(acc, v) : _mm256_max_pd(acc, v);
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, acc);
+            double best = extreme_scalar<Less>(lanes, 4);
+            for (; i < n; ++i)
+                if (Less ? p[i] < best : best < p[i])
+                    best = p[i];
+            return best;
+        }
+
+        /**
+         * @brief AVX2 minimum (Less = true) or maximum of a non-empty float buffer.
+         */
+        template <bool Less>
+        MYCONTAINER_AVX2_TARGET float extreme_avx2(const float *p, size_t n)
+        {
+            if (n < 8)
+                return extreme_scalar<Less>(p, n);
+            __m256 acc = _mm256_loadu_ps(p);
+            size_t i = 8;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256 v = _mm256_loadu_ps(p + i);
+                acc = Less ? _mm256_min_ps(acc, v) : _mm256_max_ps(acc, v);
+            }
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, acc);
+            float best = extreme_scalar<Less>(lanes, 8);
+            for (; i < n; ++i)
+                if (Less ? p[i] < best : best < p[i])
+                    best = p[i];
+            return best;
+        }
+#else
+        /**
+         * @brief AVX2 kernels are not built for this target.
+         */
+        inline bool avx2_available()
+        {
+            return false;
+        }
+#endif
+
+        /**
+         * @brief Tells whether T has AVX2 kernels (int32, float and double).
+         */
+        template <typename T>
+        constexpr bool has_simd_kernels = std::is_same_v<T, int32_t> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+        /**
+         * @brief Sums n elements with the AVX2 kernel when the CPU supports it, the scalar one otherwise.
+         */
+        template <typename T>
+        sum_t<T> sum_kernel(const T *p, size_t n)
+        {
+#if defined(MYCONTAINER_AVX2_KERNELS)
+            if constexpr (has_simd_kernels<T>)
+                if (avx2_available())
+                    return sum_avx2(p, n);
+#endif
+            return sum_scalar(p, n);
+        }
+
+        /**
+         * @brief Returns the smallest (Less = true) or largest element of a non-empty buffer,
+         * with the AVX2 kernel when the CPU supports it.
+         */
+        template <bool Less, typename T>
+        T extreme_kernel(const T *p, size_t n)
+        {
+#if defined(MYCONTAINER_AVX2_KERNELS)
+            if constexpr (has_simd_kernels<T>)
+                if (avx2_available())
+                    return extreme_avx2<Less>(p, n);
+#endif
+            return extreme_scalar<Less>(p, n);
+        }
+
+        /**
+         * @brief Counts the elements of a buffer that satisfy pred.
+         */
+        template <typename T, typename Pred>
+        size_t count_kernel(const T *p, size_t n, Pred &pred)
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < n; ++i)
+                if (pred(p[i]))
+                    ++count;
+            return count;
+        }
+
+        /**
+         * @brief Runs kernel(ptr, len) over the buffer, split into chunks on the shared pool
+         * when the buffer is at least parallel_threshold long, and folds the partial results.
+         *
+         * @param p Buffer start.
+         * @param n Buffer length (must be > 0).
+         * @param kernel Callable returning a partial result R for a sub-buffer.
+         * @param combine Callable folding two partial results.
+         * @param pool The pool to split across (defaults to WorkStealingPool::shared()).
+         * @return R The combined result.
+         */
+        template <typename R, typename T, typename Kernel, typename Combine>
+        R reduce(const T *p, size_t n, Kernel kernel, Combine combine, WorkStealingPool &pool = WorkStealingPool::shared())
+        {
+            if (n < parallel_threshold || pool.size() < 2)
+                return kernel(p, n);
+
+            size_t grain = (n + pool.size() * 4 - 1) / (pool.size() * 4);
+            std::vector<R> partials((n + grain - 1) / grain);
+            pool.parallel_for(n, [&](size_t begin, size_t end)
+                              { partials[begin / grain] = kernel(p + begin, end - begin); }, grain);
+
+            R result = partials[0];
+            for (size_t i = 1; i < partials.size(); ++i)
+                result = combine(result, partials[i]);
+            return result;
+        }
+
+    }
+}
@@ -0,0 +1,466 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+namespace containers
+{
+    namespace snapshot
+    {
+
+        /**
+         * @brief Header of a binary container snapshot (native byte order), padded to 64 bytes.
+         *
+         * Layout: header, then `count` raw elements at data_offset, then optional sections whose
+         * offsets are 0 when absent. Readers reject files whose format is newer than FORMAT.
+         */
+        struct Header
+        {
+            char magic[8];           // "MYCSNAP" followed by a zero.
+            uint32_t format;         // Snapshot format version.
+            uint32_t elem_size;      // sizeof(T) of the writer.
+            uint64_t count;          // Number of elements.
+            uint64_t version;        // Container version at save time.
+            uint64_t data_offset;    // Byte offset of the element section.
+            uint64_t checksum;       // checksum64() of the element section.
+            uint64_t lookup_offset;  // Reserved for a persisted lookup section (0 = absent).
+            uint64_t sorted_offset;  // Byte offset of the sorted-permutation section (0 = absent).
+        };
+        static_assert(sizeof(Header) == 64, "Snapshot header must be 64 bytes");
+
+        /**
+         * @brief Prefix of the sorted-permutation section, followed by `count` uint64 indices.
+         *
+         * The permutation is only trusted when data_checksum equals the header's checksum,
+         * i.e. when it was computed for exactly the elements stored in the file.
+         */
+        struct SortedSection
+        {
+            uint64_t data_checksum; // Checksum of the element section the permutation sorts.
+            uint64_t checksum;      // checksum64() of the index array.
+        };
+
+        constexpr char MAGIC[8] = {'M', 'Y', 'C', 'S', 'N', 'A', 'P', 0};
+        constexpr uint32_t FORMAT = 1;
+
+        /**
+         * @brief Throws std::runtime_error with errno's description appended, closing
+         * fd_to_close first (if not -1) without letting close() overwrite errno.
+         */
+        [[noreturn]] inline void fail(const std::string &what, int fd_to_close = -1)
+        {
+            int saved = errno;
+            if (fd_to_close >= 0)
+                ::close(fd_to_close);
+            throw std::runtime_error(what + ": " + std::strerror(saved));
+        }
+
+        /**
+         * @brief 64-bit checksum of a byte range, mixing one machine word per step.
+         *
+         * @param bytes Start of the range.
+         * @param length Number of bytes.
+         * @return uint64_t The checksum.
+         */
+        inline uint64_t checksum64(const void *bytes, size_t length)
+        {
+            const unsigned char *p = static_cast<const unsigned char *>(bytes);
+            uint64_t h = 1469598103934665603ULL ^ length;
+            size_t i = 0;
+            for (; i + 8 <= length; i += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, p + i, 8);
+                h = (h ^ word) * 1099511628211ULL;
+                h ^= h >> 29;
+            }
+            for (; i < length; ++i)
+                h = (h ^ p[i]) * 1099511628211ULL;
+            return h;
+        }
+
+        /**
+         * @brief Writes a file with plain POSIX calls and atomically replaces the target on commit().
+         *
+         * The constructor builds every path up front; open(), write(), align(), patch(),
+         * commit() and abandon() then neither allocate nor throw. They return false on
+         * failure and record the first error, which check() turns into an exception. That
+         * split lets a forked child of a multithreaded process do all the I/O: it may not
+         * call malloc (another thread could have held its lock at the fork) or unwind.
+         */
+        class Writer
+        {
+        private:
+            std::string path;     // Final path.
+            std::string tmp_path; // Path written to until commit().
+            std::string dir;      // Directory of path, synced after the rename.
+            int fd = -1;          // Descriptor of tmp_path.
+            uint64_t offset = 0;  // Bytes written so far.
+            const char *error = nullptr;         // First failed step, if any.
+            const std::string *error_path = nullptr; // The file that step was working on.
+            int error_errno = 0;                 // errno right after the failure.
+
+            /**
+             * @brief Records the first failure (keeping its errno) and returns false.
+             */
+            bool failed(const char *what, const std::string &on)
+            {
+                if (!error)
+                {
+                    error = what;
+                    error_path = &on;
+                    error_errno = errno;
+                }
+                return false;
+            }
+
+        public:
+            /**
+             * @brief Prepares to write `target + ".tmp"`; nothing is opened yet.
+             *
+             * @param target The path the snapshot will be published under.
+             */
+            explicit Writer(const std::string &target)
+                : path(target), tmp_path(target + ".tmp")
+            {
+                size_t slash = path.find_last_of('/');
+                dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+            }
+
+            Writer(const Writer &) = delete;
+            Writer &operator=(const Writer &) = delete;
+
+            /**
+             * @brief Abandons an uncommitted snapshot.
+             */
+            ~Writer()
+            {
+                abandon();
+            }
+
+            /**
+             * @brief Creates (or truncates) the temporary file.
+             */
+            bool open()
+            {
+                fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                return fd >= 0 || failed("Failed to create snapshot", tmp_path);
+            }
+
+            /**
+             * @brief Closes and removes the temporary file if it was not committed.
+             */
+            void abandon()
+            {
+                if (fd >= 0)
+                {
+                    int saved = errno;
+                    ::close(fd);
+                    ::unlink(tmp_path.c_str());
+                    fd = -1;
+                    errno = saved;
+                }
+            }
+
+            /**
+             * @brief Throws the first recorded failure, if any.
+             *
+             * @throws std::runtime_error describing the failed step, file and errno.
+             */
+            void check() const
+            {
+                if (!error)
+                    return;
+                errno = error_errno;
+                fail(std::string(error) + " " + *error_path);
+            }
+
+            /**
+             * @brief Returns the offset the next write() lands at.
+             */
+            uint64_t position() const
+            {
+                return offset;
+            }
+
+            /**
+             * @brief Appends bytes, retrying short writes.
+             */
+            bool write(const void *bytes, size_t length)
+            {
+                const char *p = static_cast<const char *>(bytes);
+                while (length > 0)
+                {
+                    ssize_t n = ::write(fd, p, length);
+                    if (n < 0)
+                    {
+                        if (errno == EINTR)
+                            continue;
+                        return failed("Failed to write snapshot", tmp_path);
+                    }
+                    p += n;
+                    length -= static_cast<size_t>(n);
+                    offset += static_cast<uint64_t>(n);
+                }
+                return true;
+            }
+
+            /**
+             * @brief Pads with zeros up to a multiple of alignment.
+             */
+            bool align(size_t alignment)
+            {
+                static const char zeros[64] = {};
+                while (offset % alignment != 0)
+                    if (!write(zeros, std::min<size_t>(alignment - offset % alignment, sizeof(zeros))))
+                        return false;
+                return true;
+            }
+
+            /**
+             * @brief Overwrites bytes at an earlier offset (used to finalize the header).
+             */
+            bool patch(uint64_t at, const void *bytes, size_t length)
+            {
+                return ::pwrite(fd, bytes, length, static_cast<off_t>(at)) == static_cast<ssize_t>(length) ||
+                       failed("Failed to write snapshot", tmp_path);
+            }
+
+            /**
+             * @brief Flushes to disk, renames the file over the target path and syncs the directory.
+             *
+             * When it returns true, the new snapshot is durable under its final name.
+             */
+            bool commit()
+            {
+                if (::fsync(fd) != 0)
+                    return failed("Failed to sync snapshot", tmp_path);
+                ::close(fd);
+                fd = -1;
+                if (::rename(tmp_path.c_str(), path.c_str()) != 0)
+                {
+                    failed("Failed to publish snapshot", path);
+                    ::unlink(tmp_path.c_str());
+                    return false;
+                }
+                int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+                if (dfd < 0)
+                    return failed("Failed to open directory", dir);
+                bool synced = ::fsync(dfd) == 0 || failed("Failed to sync directory", dir);
+                ::close(dfd);
+                return synced;
+            }
+        };
+
+        /**
+         * @brief Read-only mapping of a snapshot file with a validated header.
+         */
+        class Reader
+        {
+        private:
+            int fd = -1;           // Descriptor of the snapshot.
+            void *base = nullptr;  // Start of the mapping.
+            size_t length = 0;     // Length of the mapping.
+
+        public:
+            /**
+             * @brief Maps path and validates its header against the element size.
+             *
+             * @param path Snapshot file.
+             * @param elem_size sizeof(T) expected by the caller.
+             * @throws std::runtime_error if the file is missing, truncated or not a compatible snapshot.
+             */
+            Reader(const std::string &path, size_t elem_size)
+            {
+                fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    fail("Failed to open snapshot " + path);
+                struct stat st;
+                if (::fstat(fd, &st) != 0)
+                    fail("Failed to stat snapshot " + path, fd);
+                length = static_cast<size_t>(st.st_size);
+                if (length < sizeof(Header))
+                {
+                    ::close(fd);
+                    throw std::runtime_error("Not a container snapshot: " + path);
+                }
+                base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (base == MAP_FAILED)
+                    fail("Failed to map snapshot " + path, fd);
+                ::madvise(base, length, MADV_SEQUENTIAL);
+
+                const Header &h = header();
+                bool valid = std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.format <= FORMAT &&
+                             h.elem_size == elem_size && h.data_offset <= length &&
+                             h.count <= (length - h.data_offset) / elem_size;
+                if (!valid)
+                {
+                    ::munmap(base, length);
+                    ::close(fd);
+                    throw std::runtime_error("Not a compatible container snapshot: " + path);
+                }
+            }
+
+            Reader(const Reader &) = delete;
+            Reader &operator=(const Reader &) = delete;
+
+            /**
+             * @brief Unmaps and closes the snapshot.
+             */
+            ~Reader()
+            {
+                ::munmap(base, length);
+                ::close(fd);
+            }
+
+            /**
+             * @brief Returns the validated header.
+             */
+            const Header &header() const
+            {
+                return *static_cast<const Header *>(base);
+            }
+
+            /**
+             * @brief Returns a pointer `offset` bytes into the file.
+             */
+            const void *at(uint64_t offset) const
+            {
+                return static_cast<const char *>(base) + offset;
+            }
+
+            /**
+             * @brief Returns the file length in bytes.
+             */
+            size_t size() const
+            {
+                return length;
+            }
+        };
+
+    }
+
+    /**
+     * @brief Handle of a snapshot being written by a forked child process.
+     *
+     * Returned by MyContainer::background_snapshot(). The destructor reaps the child if the
+     * caller never waited for it, so no zombie is left behind.
+     */
+    class SnapshotJob
+    {
+    public:
+        /**
+         * @brief Progress of the child.
+         */
+        enum class Status
+        {
+            Running,
+            Succeeded,
+            Failed
+        };
+
+    private:
+        pid_t pid = -1;                  // Child process, -1 once reaped.
+        std::string path;                // Snapshot being written.
+        Status state = Status::Running;  // Last observed status.
+
+        /**
+         * @brief Records the child's exit status.
+         */
+        void finish(int wait_status)
+        {
+            pid = -1;
+            state = WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0 ? Status::Succeeded : Status::Failed;
+        }
+
+    public:
+        /**
+         * @brief Wraps a running child.
+         *
+         * @param child Process id returned by fork().
+         * @param target Path the child is writing.
+         */
+        SnapshotJob(pid_t child, std::string target)
+            : pid(child), path(std::move(target)) {}
+
+        SnapshotJob(const SnapshotJob &) = delete;
+        SnapshotJob &operator=(const SnapshotJob &) = delete;
+
+        /**
+         * @brief Moves the handle; the source no longer owns the child.
+         */
+        SnapshotJob(SnapshotJob &&other) noexcept
+            : pid(other.pid), path(std::move(other.path)), state(other.state)
+        {
+            other.pid = -1;
+        }
+
+        /**
+         * @brief Waits for the child if it is still unreaped.
+         */
+        ~SnapshotJob()
+        {
+            if (pid > 0)
+                wait();
+        }
+
+        /**
+         * @brief Polls the child without blocking.
+         *
+         * @return Status Running until the child exits, then Succeeded or Failed.
+         */
+        Status status()
+        {
+            if (pid > 0)
+            {
+                int wait_status = 0;
+                pid_t r = ::waitpid(pid, &wait_status, WNOHANG);
+                if (r == pid)
+                    finish(wait_status);
+                else if (r < 0)
+                    finish(1 << 8);
+            }
+            return state;
+        }
+
+        /**
+         * @brief Blocks until the child exits.
+         *
+         * @return true If the snapshot was written and published.
+         */
+        bool wait()
+        {
+            while (pid > 0)
+            {
+                int wait_status = 0;
+                pid_t r = ::waitpid(pid, &wait_status, 0);
+                if (r == pid)
+                    finish(wait_status);
+                else if (r < 0 && errno != EINTR)
+                    finish(1 << 8);
+            }
+            return state == Status::Succeeded;
+        }
+
+        /**
+         * @brief Returns the path being written.
+         */
+        const std::string &target() const
+        {
+            return path;
+        }
+    };
+
+}
@@ -0,0 +1,308 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+#include <unistd.h>
+
+namespace containers
+{
+    namespace trace
+    {
+
+        /**
+         * @brief One complete ("ph": "X") Chrome trace event.
+         */
+        struct Event
+        {
+            const char *name;     // Operation, e.g. "sort".
+            const char *category; // "iterator", "sort", "mutation" or "compaction".
+            uint64_t start_ns;    // Start, relative to the recorder's origin.
+            uint64_t duration_ns; // Duration.
+            uint32_t tid;         // Small per-thread id.
+            uint64_t n;           // Number of elements the operation worked on.
+        };
+
+        /**
+         * @brief Process-wide buffer of trace events, written as Chrome trace JSON.
+         *
+         * Tracing is on from startup when the MYCONTAINER_TRACE environment variable names an
+         * output file, or when the program is compiled with MYCONTAINER_TRACE defined (output
+         * goes to $MYCONTAINER_TRACE, or mycontainer_trace.json if it is unset). It can also
+         * be switched on and off with start() / stop(). Events are kept in memory and the file
+         * is (re)written by flush() and at exit. The file loads in chrome://tracing and Perfetto.
+         *
+         * The buffer is a ring of at most capacity() events (DEFAULT_CAPACITY unless start()
+         * says otherwise): once full, each new event overwrites the oldest, so a long run keeps
+         * its most recent events in bounded memory. dropped() counts the overwritten events,
+         * and the file reports it as otherData.dropped_events.
+         *
+         * When tracing is off, a Scope costs one relaxed atomic load.
+         */
+        class Recorder
+        {
+        public:
+            static constexpr size_t DEFAULT_CAPACITY = size_t(1) << 18; // Events kept by default (12 MiB).
+
+        private:
+            std::atomic<bool> on{false};                      // Whether Scopes record.
+            std::mutex mutex;                                 // Guards events, path and the ring state.
+            std::vector<Event> events;                        // Ring of buffered events.
+            size_t limit = DEFAULT_CAPACITY;                  // Maximum number of buffered events.
+            size_t head = 0;                                  // Oldest event once the ring is full.
+            uint64_t overwritten = 0;                         // Events dropped since the last start().
+            std::string path;                                 // Output file.
+            bool dirty = false;                               // Events recorded since the last write.
+            const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+            Recorder()
+            {
+                const char *env = std::getenv("MYCONTAINER_TRACE");
+#ifdef MYCONTAINER_TRACE
+                path = env && *env ? env : "mycontainer_trace.json";
+                on.store(true, std::memory_order_relaxed);
+#else
+                if (env && *env)
+                {
+                    path = env;
+                    on.store(true, std::memory_order_relaxed);
+                }
+#endif
+            }
+
+            /**
+             * @brief Writes the buffered events; caller holds mutex.
+             */
+            bool write_locked()
+            {
+                if (path.empty())
+                    return false;
+                std::FILE *f = std::fopen(path.c_str(), "w");
+                if (!f)
+                    return false;
+                std::fprintf(f, "{\"traceEvents\": [\n");
+                long pid = static_cast<long>(::getpid());
+                for (size_t i = 0; i < events.size(); ++i)
+                {
+                    const Event &e = events[(head + i) % events.size()];
+                    std::fprintf(f,
+                                 "  {\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                                 "\"pid\": %ld, \"tid\": %u, \"args\": {\"n\": %llu}}%s\n",
+                                 e.name, e.category, static_cast<double>(e.start_ns) / 1000.0,
+                                 static_cast<double>(e.duration_ns) / 1000.0, pid, e.tid,
+                                 static_cast<unsigned long long>(e.n), i + 1 < events.size() ? "," : "");
+                }
+                std::fprintf(f, "], \"displayTimeUnit\": \"ns\", \"otherData\": {\"dropped_events\": %llu}}\n",
+                             static_cast<unsigned long long>(overwritten));
+                dirty = false;
+                return std::fclose(f) == 0;
+            }
+
+        public:
+            Recorder(const Recorder &) = delete;
+            Recorder &operator=(const Recorder &) = delete;
+
+            /**
+             * @brief Writes events not flushed yet to the trace file on normal exit.
+             */
+            ~Recorder()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (dirty)
+                    write_locked();
+            }
+
+            /**
+             * @brief Returns the process-wide recorder.
+             */
+            static Recorder &instance()
+            {
+                static Recorder recorder;
+                return recorder;
+            }
+
+            /**
+             * @brief Returns true while events are being recorded.
+             */
+            bool enabled() const
+            {
+                return on.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Starts recording into a fresh buffer that will be written to file.
+             *
+             * @param file Output path of the Chrome trace JSON.
+             * @param max_events Number of most recent events to keep (at least 1).
+             */
+            void start(const std::string &file, size_t max_events = DEFAULT_CAPACITY)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                path = file;
+                events.clear();
+                limit = max_events == 0 ? 1 : max_events;
+                head = 0;
+                overwritten = 0;
+                dirty = false;
+                on.store(true, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Stops recording; buffered events are kept until the next start().
+             */
+            void stop()
+            {
+                on.store(false, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Writes every buffered event to the output file.
+             *
+             * @return true If the file was written.
+             */
+            bool flush()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return write_locked();
+            }
+
+            /**
+             * @brief Returns the number of buffered events.
+             */
+            size_t size()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return events.size();
+            }
+
+            /**
+             * @brief Returns the maximum number of buffered events.
+             */
+            size_t capacity()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return limit;
+            }
+
+            /**
+             * @brief Returns the number of events overwritten because the buffer was full.
+             */
+            uint64_t dropped()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return overwritten;
+            }
+
+            /**
+             * @brief Returns nanoseconds since the recorder was created.
+             */
+            uint64_t now_ns() const
+            {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                 std::chrono::steady_clock::now() - origin)
+                                                 .count());
+            }
+
+            /**
+             * @brief Appends one event, overwriting the oldest one when the buffer is full.
+             */
+            void record(const Event &e)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (events.size() < limit)
+                    events.push_back(e);
+                else
+                {
+                    events[head] = e;
+                    head = (head + 1) % limit;
+                    ++overwritten;
+                }
+                dirty = true;
+            }
+        };
+
+        /**
+         * @brief Returns a small, stable id for the calling thread.
+         */
+        inline uint32_t thread_id()
+        {
+            static std::atomic<uint32_t> next{0};
+            thread_local uint32_t id = ++next;
+            return id;
+        }
+
+        /**
+         * @brief Records the lifetime of a block as one trace event (when tracing is on).
+         */
+        class Scope
+        {
+        private:
+            const char *name;     // Operation name.
+            const char *category; // Event category.
+            uint64_t n;           // Elements involved.
+            uint64_t start = 0;   // Start time; only meaningful when active.
+            bool active;          // Whether tracing was on when the scope began.
+
+        public:
+            /**
+             * @brief Starts timing if tracing is on.
+             *
+             * @param event_name Operation name (must outlive the recorder, e.g. a literal).
+             * @param event_category Event category (a literal).
+             * @param elements Number of elements the operation works on.
+             */
+            Scope(const char *event_name, const char *event_category, uint64_t elements)
+                : name(event_name), category(event_category), n(elements),
+                  active(Recorder::instance().enabled())
+            {
+                if (active)
+                    start = Recorder::instance().now_ns();
+            }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+            /**
+             * @brief Records the event.
+             */
+            ~Scope()
+            {
+                if (!active)
+                    return;
+                Recorder &r = Recorder::instance();
+                r.record(Event{name, category, start, r.now_ns() - start, thread_id(), n});
+            }
+        };
+
+        /**
+         * @brief Starts recording to file (see Recorder::start()).
+         */
+        inline void start(const std::string &file, size_t max_events = Recorder::DEFAULT_CAPACITY)
+        {
+            Recorder::instance().start(file, max_events);
+        }
+
+        /**
+         * @brief Stops recording (see Recorder::stop()).
+         */
+        inline void stop()
+        {
+            Recorder::instance().stop();
+        }
+
+        /**
+         * @brief Writes the buffered events now (see Recorder::flush()).
+         */
+        inline bool flush()
+        {
+            return Recorder::instance().flush();
+        }
+
+    }
+}
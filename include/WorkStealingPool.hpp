@@ -0,0 +1,244 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <algorithm>
+
+namespace containers
+{
+
+    /**
+     * @brief A fixed-size thread pool where idle workers steal queued tasks from busy ones.
+     *
+     * Every worker owns a deque: it pops its own newest task first and, when empty, steals the
+     * oldest task of another worker. The thread waiting in parallel_for() also runs queued tasks,
+     * so nested parallel loops on the same pool cannot deadlock.
+     */
+    class WorkStealingPool
+    {
+    private:
+        using Task = std::function<void()>;
+
+        /**
+         * @brief A worker's task deque.
+         */
+        struct alignas(64) Queue
+        {
+            std::mutex mutex;       // Guards tasks.
+            std::deque<Task> tasks; // Owner pops at the back, thieves take from the front.
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues; // One queue per worker.
+        std::vector<std::thread> workers;           // Worker threads.
+        std::atomic<size_t> queued{0};              // Tasks sitting in any queue.
+        std::atomic<size_t> next_queue{0};          // Round-robin cursor for submissions.
+        std::mutex sleep_mutex;                     // Guards sleeping workers.
+        std::condition_variable wake;               // Signalled on submission and shutdown.
+        bool stopping = false;                      // Set once by the destructor.
+
+        /**
+         * @brief Pops the newest task of queue `id`.
+         */
+        bool pop_local(size_t id, Task &task)
+        {
+            Queue &q = *queues[id];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty())
+                return false;
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+
+        /**
+         * @brief Steals the oldest task of any queue other than `self`.
+         */
+        bool steal(size_t self, Task &task)
+        {
+            for (size_t k = 1; k <= queues.size(); ++k)
+            {
+                size_t victim = (self + k) % queues.size();
+                if (victim == self)
+                    continue;
+                Queue &q = *queues[victim];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (q.tasks.empty())
+                    continue;
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                queued.fetch_sub(1);
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Main loop of worker `id`: run local work, then steal, then sleep.
+         */
+        void run_worker(size_t id)
+        {
+            Task task;
+            while (true)
+            {
+                if (pop_local(id, task) || steal(id, task))
+                {
+                    task();
+                    task = nullptr;
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                wake.wait(lock, [this]()
+                          { return stopping || queued.load() > 0; });
+                if (stopping && queued.load() == 0)
+                    return;
+            }
+        }
+
+        /**
+         * @brief Pushes a task onto the next queue in round-robin order.
+         */
+        void submit(Task task)
+        {
+            Queue &q = *queues[next_queue.fetch_add(1) % queues.size()];
+            {
+                std::lock_guard<std::mutex> lock(q.mutex);
+                q.tasks.push_back(std::move(task));
+                queued.fetch_add(1);
+            }
+            {
+                // Pairs with the predicate check in run_worker so the wake-up cannot be lost.
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+            }
+            wake.notify_one();
+        }
+
+    public:
+        /**
+         * @brief Starts the pool.
+         *
+         * @param worker_count Number of worker threads; 0 means std::thread::hardware_concurrency().
+         */
+        explicit WorkStealingPool(size_t worker_count = 0)
+        {
+            if (worker_count == 0)
+                worker_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+            for (size_t i = 0; i < worker_count; ++i)
+                queues.push_back(std::make_unique<Queue>());
+            for (size_t i = 0; i < worker_count; ++i)
+                workers.emplace_back([this, i]()
+                                     { run_worker(i); });
+        }
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        /**
+         * @brief Drains the remaining tasks and joins all workers.
+         */
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto &worker : workers)
+                worker.join();
+        }
+
+        /**
+         * @brief Returns the number of worker threads.
+         *
+         * @return size_t Worker count.
+         */
+        size_t size() const
+        {
+            return workers.size();
+        }
+
+        /**
+         * @brief Splits [0, count) into chunks and runs fn(begin, end) on each, blocking until all finish.
+         *
+         * The calling thread helps by running queued tasks while it waits. If any chunk throws,
+         * the first exception is rethrown here after every chunk has finished.
+         *
+         * @param count Size of the index range.
+         * @param fn Callable invoked as fn(size_t begin, size_t end).
+         * @param grain Minimum chunk length; 0 picks about eight chunks per worker.
+         */
+        template <typename Fn>
+        void parallel_for(size_t count, Fn fn, size_t grain = 0)
+        {
+            if (count == 0)
+                return;
+            if (grain == 0)
+                grain = std::max<size_t>(1, count / (size() * 8));
+            size_t chunks = (count + grain - 1) / grain;
+
+            struct Batch
+            {
+                std::atomic<size_t> remaining;
+                std::mutex mutex;
+                std::condition_variable done;
+                std::exception_ptr error;
+            };
+            auto batch = std::make_shared<Batch>();
+            batch->remaining = chunks;
+
+            for (size_t c = 0; c < chunks; ++c)
+            {
+                size_t begin = c * grain;
+                size_t end = std::min(count, begin + grain);
+                submit([batch, begin, end, &fn]()
+                       {
+                           try
+                           {
+                               fn(begin, end);
+                           }
+                           catch (...)
+                           {
+                               std::lock_guard<std::mutex> lock(batch->mutex);
+                               if (!batch->error)
+                                   batch->error = std::current_exception();
+                           }
+                           if (batch->remaining.fetch_sub(1) == 1)
+                           {
+                               std::lock_guard<std::mutex> lock(batch->mutex);
+                               batch->done.notify_all();
+                           } });
+            }
+
+            Task task;
+            while (batch->remaining.load() != 0 && steal(queues.size(), task))
+            {
+                task();
+                task = nullptr;
+            }
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->done.wait(lock, [&]()
+                             { return batch->remaining.load() == 0; });
+            if (batch->error)
+                std::rethrow_exception(batch->error);
+        }
+
+        /**
+         * @brief Returns the process-wide pool used when no pool is passed explicitly.
+         *
+         * @return WorkStealingPool& A pool with one worker per hardware thread.
+         */
+        static WorkStealingPool &shared()
+        {
+            static WorkStealingPool pool;
+            return pool;
+        }
+    };
+
+}
@@ -0,0 +1,226 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+namespace containers
+{
+    namespace workloads
+    {
+
+        /**
+         * @brief Shapes of generated input sequences.
+         */
+        enum class Distribution
+        {
+            Uniform,       // Independent uniform keys.
+            Zipfian,       // Skewed keys (theta 0.99): a few values account for most of the sequence.
+            Sorted,        // Uniform keys in ascending order.
+            ReverseSorted, // Uniform keys in descending order.
+            Sawtooth,      // Ascending runs of about sqrt(n) keys that restart from the bottom.
+            FewDistinct,   // Uniform over 16 distinct keys.
+            AllDuplicate   // One key repeated n times.
+        };
+
+        /**
+         * @brief Every distribution, for tests and benchmarks that sweep them all.
+         */
+        constexpr Distribution ALL[] = {Distribution::Uniform, Distribution::Zipfian, Distribution::Sorted,
+                                        Distribution::ReverseSorted, Distribution::Sawtooth,
+                                        Distribution::FewDistinct, Distribution::AllDuplicate};
+
+        /**
+         * @brief Returns the display name of a distribution.
+         */
+        inline const char *name(Distribution d)
+        {
+            switch (d)
+            {
+            case Distribution::Uniform:
+                return "uniform";
+            case Distribution::Zipfian:
+                return "zipfian";
+            case Distribution::Sorted:
+                return "sorted";
+            case Distribution::ReverseSorted:
+                return "reverse_sorted";
+            case Distribution::Sawtooth:
+                return "sawtooth";
+            case Distribution::FewDistinct:
+                return "few_distinct";
+            case Distribution::AllDuplicate:
+                return "all_duplicate";
+            }
+            return "unknown";
+        }
+
+        /**
+         * @brief splitmix64: a tiny, fast generator whose output depends only on the seed.
+         *
+         * Used instead of <random> engines and distributions, whose results may differ between
+         * standard library implementations.
+         */
+        class SplitMix64
+        {
+        private:
+            uint64_t state; // Advanced by a fixed odd constant per draw.
+
+        public:
+            explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+            /**
+             * @brief Returns the next 64 random bits.
+             */
+            uint64_t operator()()
+            {
+                uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            }
+
+            /**
+             * @brief Returns a uniform double in [0, 1).
+             */
+            double uniform()
+            {
+                return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0);
+            }
+        };
+
+        /**
+         * @brief Converts a 31-bit key to an element, preserving key order for every supported type.
+         *
+         * int keeps the key, double halves it (exactly representable), and std::string
+         * zero-pads it to 10 digits so lexicographic order equals numeric order.
+         */
+        template <typename T>
+        T make_value(uint64_t key)
+        {
+            if constexpr (std::is_same<T, std::string>::value)
+            {
+                std::string digits = std::to_string(key);
+                return std::string(10 - std::min<size_t>(10, digits.size()), '0') + digits;
+            }
+            else if constexpr (std::is_floating_point<T>::value)
+            {
+                return static_cast<T>(key) * static_cast<T>(0.5);
+            }
+            else
+            {
+                static_assert(std::is_integral<T>::value, "make_value supports integral, floating-point and std::string");
+                return static_cast<T>(key);
+            }
+        }
+
+        /**
+         * @brief Generates the keys (0 <= key < 2^31) of a sequence; make_value() turns them into elements.
+         *
+         * The result depends only on (d, n, seed).
+         *
+         * @param d Shape of the sequence.
+         * @param n Number of keys.
+         * @param seed Generator seed.
+         * @return std::vector<uint64_t> The keys.
+         */
+        inline std::vector<uint64_t> generate_keys(Distribution d, size_t n, uint64_t seed)
+        {
+            SplitMix64 rng(seed);
+            std::vector<uint64_t> keys(n);
+            auto uniform_key = [&rng]()
+            { return rng() >> 33; };
+
+            switch (d)
+            {
+            case Distribution::Uniform:
+                for (auto &k : keys)
+                    k = uniform_key();
+                break;
+            case Distribution::Sorted:
+            case Distribution::ReverseSorted:
+                for (auto &k : keys)
+                    k = uniform_key();
+                std::sort(keys.begin(), keys.end());
+                if (d == Distribution::ReverseSorted)
+                    std::reverse(keys.begin(), keys.end());
+                break;
+            case Distribution::Zipfian:
+            {
+                // Gray et al., "Quickly generating billion-record synthetic databases": ranks
+                // 0..n-1 with P(rank) proportional to 1 / (rank + 1)^theta. Ranks are scattered
+                // over the key space so the popular values are not simply the smallest ones.
+                const double theta = 0.99;
+                const size_t domain = std::max<size_t>(n, 2);
+                double zetan = 0;
+                for (size_t i = 1; i <= domain; ++i)
+                    zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+                const double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+                const double alpha = 1.0 / (1.0 - theta);
+                const double eta = (1.0 - std::pow(2.0 / static_cast<double>(domain), 1.0 - theta)) / (1.0 - zeta2 / zetan);
+                for (auto &k : keys)
+                {
+                    double u = rng.uniform();
+                    double uz = u * zetan;
+                    uint64_t rank;
+                    if (uz < 1.0)
+                        rank = 0;
+                    else if (uz < zeta2)
+                        rank = 1;
+                    else
+                        rank = std::min<uint64_t>(domain - 1, static_cast<uint64_t>(static_cast<double>(domain) *
+                                                                                   std::pow(eta * u - eta + 1.0, alpha)));
+                    k = SplitMix64(seed ^ rank)() >> 33;
+                }
+                break;
+            }
+            case Distribution::Sawtooth:
+            {
+                size_t tooth = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(n))));
+                uint64_t step = (uint64_t(1) << 31) / tooth;
+                uint64_t offset = uniform_key() % step;
+                for (size_t i = 0; i < n; ++i)
+                    keys[i] = (i % tooth) * step + offset;
+                break;
+            }
+            case Distribution::FewDistinct:
+            {
+                uint64_t pool[16];
+                for (auto &p : pool)
+                    p = uniform_key();
+                for (auto &k : keys)
+                    k = pool[rng() % 16];
+                break;
+            }
+            case Distribution::AllDuplicate:
+                std::fill(keys.begin(), keys.end(), uniform_key());
+                break;
+            }
+            return keys;
+        }
+
+        /**
+         * @brief Generates a deterministic sequence of n elements of type T.
+         *
+         * @tparam T int (or another integral type), double (or float) or std::string.
+         * @param d Shape of the sequence.
+         * @param n Number of elements.
+         * @param seed Generator seed; the same seed always yields the same sequence.
+         * @return std::vector<T> The elements.
+         */
+        template <typename T>
+        std::vector<T> generate(Distribution d, size_t n, uint64_t seed = 1)
+        {
+            std::vector<uint64_t> keys = generate_keys(d, n, seed);
+            std::vector<T> values;
+            values.reserve(n);
+            for (uint64_t k : keys)
+                values.push_back(make_value<T>(k));
+            return values;
+        }
+
+    }
+}
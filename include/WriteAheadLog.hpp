@@ -0,0 +1,383 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "Snapshot.hpp"
+
+namespace containers
+{
+
+    /**
+     * @brief Group-commit triggers of a WriteAheadLog.
+     */
+    struct WalOptions
+    {
+        size_t group_bytes = 64 * 1024;           // Commit once the batch holds this many bytes.
+        std::chrono::milliseconds group_delay{5}; // Commit batches older than this (0 disables the flusher).
+    };
+
+    /**
+     * @brief An append-only log of add/remove operations with group commit.
+     *
+     * append() only copies the record into an in-memory batch. The batch is written and
+     * fdatasync'ed as one unit when it reaches group_bytes, when it is older than group_delay
+     * (checked by a background flusher), or on an explicit commit(). A single sync therefore
+     * covers every operation appended since the previous one.
+     *
+     * A failed write or sync truncates the file back to the last synced record and is
+     * sticky: every later append(), commit() or reset() rethrows it, since the kernel may
+     * already have dropped the unsynced pages. Reopen the log to recover.
+     *
+     * File layout: a 32-byte header (magic, format, element size, base version) followed by
+     * fixed-size records [op:1][value:sizeof(T)][check:4]. base_version is the container
+     * version the first record applies on top of; record i produces version base + i + 1.
+     *
+     * @tparam T The element type (must be trivially copyable).
+     */
+    template <typename T>
+    class WriteAheadLog
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "WriteAheadLog requires a trivially copyable type");
+
+    public:
+        /**
+         * @brief Logged operation kinds.
+         */
+        enum class Op : uint8_t
+        {
+            Add = 1,
+            Remove = 2
+        };
+
+        using Options = WalOptions;
+
+    private:
+        /**
+         * @brief On-disk header.
+         */
+        struct Header
+        {
+            char magic[8];         // "MYCWAL" followed by zeros.
+            uint32_t format;       // Log format version.
+            uint32_t elem_size;    // sizeof(T) of the writer.
+            uint64_t base_version; // Container version before the first record.
+            uint64_t reserved;     // Pads the header to 32 bytes.
+        };
+        static_assert(sizeof(Header) == 32, "WAL header must be 32 bytes");
+
+        static constexpr char MAGIC[8] = {'M', 'Y', 'C', 'W', 'A', 'L', 0, 0};
+        static constexpr uint32_t FORMAT = 1;
+        static constexpr size_t RECORD_SIZE = 1 + sizeof(T) + 4;
+
+        std::string path;   // Log file.
+        Options options;    // Group-commit triggers.
+        int fd = -1;        // Descriptor opened for appending.
+        Header header{};    // Current header.
+        off_t synced_end = 0; // End of the last synced record; a failed commit truncates back to it.
+
+        std::mutex batch_mutex;              // Guards batch, batch_start, failure and stopping.
+        std::mutex io_mutex;                 // Serializes commits so batches reach the file in order.
+        std::vector<char> batch;             // Encoded records not yet written.
+        std::chrono::steady_clock::time_point batch_start; // When the oldest record in batch was appended.
+        std::condition_variable flusher_wake; // Wakes the flusher early on shutdown.
+        std::string failure;                 // First commit error; non-empty once the log is unusable.
+        bool stopping = false;               // Tells the flusher to exit.
+        std::thread flusher;                 // Time-triggered group committer.
+
+        /**
+         * @brief Checksum stored in a record, over its op and value bytes.
+         */
+        static uint32_t record_check(const char *record)
+        {
+            return static_cast<uint32_t>(snapshot::checksum64(record, 1 + sizeof(T)));
+        }
+
+        /**
+         * @brief Writes the header at offset 0 without moving the append offset.
+         */
+        void write_header()
+        {
+            if (::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+                snapshot::fail("Failed to write WAL header " + path);
+        }
+
+        /**
+         * @brief Appends bytes at the end of the log, retrying short writes.
+         */
+        void write_all(const char *p, size_t length)
+        {
+            while (length > 0)
+            {
+                ssize_t n = ::write(fd, p, length);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    snapshot::fail("Failed to append to WAL " + path);
+                }
+                p += n;
+                length -= static_cast<size_t>(n);
+            }
+        }
+
+        /**
+         * @brief Throws the latched commit error, if any; caller holds batch_mutex.
+         */
+        void check_failure() const
+        {
+            if (!failure.empty())
+                throw std::runtime_error("WAL " + path + " is unusable after an earlier failure (" + failure + ")");
+        }
+
+        /**
+         * @brief Background loop committing batches older than group_delay.
+         */
+        void run_flusher()
+        {
+            std::unique_lock<std::mutex> lock(batch_mutex);
+            while (!stopping)
+            {
+                flusher_wake.wait_for(lock, options.group_delay);
+                if (stopping || batch.empty() ||
+                    std::chrono::steady_clock::now() - batch_start < options.group_delay)
+                    continue;
+                lock.unlock();
+                try
+                {
+                    commit();
+                }
+                catch (const std::exception &)
+                {
+                    // commit() latched the error; the next append() or commit() rethrows it.
+                }
+                lock.lock();
+            }
+        }
+
+    public:
+        /**
+         * @brief Opens (or creates) the log at path.
+         *
+         * @param log_path Log file.
+         * @param opts Group-commit triggers.
+         * @throws std::runtime_error if the file cannot be opened or belongs to another element type.
+         */
+        explicit WriteAheadLog(const std::string &log_path, Options opts = Options())
+            : path(log_path), options(opts)
+        {
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0)
+                snapshot::fail("Failed to open WAL " + path);
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+                snapshot::fail("Failed to stat WAL " + path, fd);
+            if (st.st_size == 0)
+            {
+                std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+                header.format = FORMAT;
+                header.elem_size = sizeof(T);
+                write_header();
+            }
+            else if (st.st_size < static_cast<off_t>(sizeof(Header)) ||
+                     ::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+                     std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.format != FORMAT ||
+                     header.elem_size != sizeof(T))
+            {
+                ::close(fd);
+                throw std::runtime_error("Not a WAL for this element type: " + path);
+            }
+            synced_end = ::lseek(fd, 0, SEEK_END);
+            if (options.group_delay.count() > 0)
+                flusher = std::thread([this]()
+                                      { run_flusher(); });
+        }
+
+        WriteAheadLog(const WriteAheadLog &) = delete;
+        WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+        /**
+         * @brief Stops the flusher and commits whatever is still batched.
+         */
+        ~WriteAheadLog()
+        {
+            {
+                std::lock_guard<std::mutex> lock(batch_mutex);
+                stopping = true;
+            }
+            flusher_wake.notify_all();
+            if (flusher.joinable())
+                flusher.join();
+            try
+            {
+                commit();
+            }
+            catch (const std::exception &)
+            {
+                // Destructors must not throw; the unsynced tail is lost like on a crash.
+            }
+            ::close(fd);
+        }
+
+        /**
+         * @brief Returns the container version the first record applies to.
+         */
+        uint64_t base_version() const
+        {
+            return header.base_version;
+        }
+
+        /**
+         * @brief Feeds every intact record to fn and truncates a torn or corrupt tail.
+         *
+         * Call once at startup, before any append().
+         *
+         * @param fn Callable invoked as fn(Op, const T&, uint64_t version_after).
+         * @return size_t Number of records replayed.
+         */
+        template <typename Fn>
+        size_t replay(Fn fn)
+        {
+            std::lock_guard<std::mutex> io_lock(io_mutex);
+            off_t end = ::lseek(fd, 0, SEEK_END);
+            if (end < 0)
+                snapshot::fail("Failed to seek WAL " + path);
+
+            std::vector<char> bytes(static_cast<size_t>(end) - sizeof(Header));
+            if (!bytes.empty() &&
+                ::pread(fd, bytes.data(), bytes.size(), sizeof(Header)) != static_cast<ssize_t>(bytes.size()))
+                snapshot::fail("Failed to read WAL " + path);
+
+            size_t count = 0;
+            size_t offset = 0;
+            for (; offset + RECORD_SIZE <= bytes.size(); offset += RECORD_SIZE)
+            {
+                const char *record = bytes.data() + offset;
+                uint32_t check;
+                std::memcpy(&check, record + 1 + sizeof(T), 4);
+                Op op = static_cast<Op>(record[0]);
+                if (check != record_check(record) || (op != Op::Add && op != Op::Remove))
+                    break;
+                T value;
+                std::memcpy(&value, record + 1, sizeof(T));
+                ++count;
+                fn(op, value, header.base_version + count);
+            }
+            if (offset != bytes.size() &&
+                ::ftruncate(fd, static_cast<off_t>(sizeof(Header) + offset)) != 0)
+                snapshot::fail("Failed to truncate WAL " + path);
+            synced_end = ::lseek(fd, 0, SEEK_END);
+            return count;
+        }
+
+        /**
+         * @brief Batches one operation; commits immediately if the batch reached group_bytes.
+         *
+         * The operation is durable only after the next commit (explicit or triggered).
+         *
+         * @param op Operation kind.
+         * @param value Operand.
+         * @throws std::runtime_error if a triggered commit fails or an earlier one did (nothing is batched then).
+         */
+        void append(Op op, const T &value)
+        {
+            char record[RECORD_SIZE];
+            record[0] = static_cast<char>(op);
+            std::memcpy(record + 1, &value, sizeof(T));
+            uint32_t check = record_check(record);
+            std::memcpy(record + 1 + sizeof(T), &check, 4);
+
+            bool full;
+            {
+                std::lock_guard<std::mutex> lock(batch_mutex);
+                check_failure();
+                if (batch.empty())
+                    batch_start = std::chrono::steady_clock::now();
+                batch.insert(batch.end(), record, record + RECORD_SIZE);
+                full = batch.size() >= options.group_bytes;
+            }
+            if (full)
+                commit();
+        }
+
+        /**
+         * @brief Writes the current batch and syncs it; returns once everything appended so far is durable.
+         *
+         * Appends may continue while the sync is in progress; they go into the next batch.
+         * On failure the batch is put back in front of newer appends, the file is truncated
+         * to the last synced record and the error is latched (see the class comment).
+         *
+         * @throws std::runtime_error on I/O failure, now or in an earlier commit.
+         */
+        void commit()
+        {
+            std::lock_guard<std::mutex> io_lock(io_mutex);
+            std::vector<char> pending;
+            std::chrono::steady_clock::time_point pending_start;
+            {
+                std::lock_guard<std::mutex> lock(batch_mutex);
+                check_failure();
+                pending.swap(batch);
+                pending_start = batch_start;
+            }
+            if (pending.empty())
+                return;
+            try
+            {
+                write_all(pending.data(), pending.size());
+                if (::fdatasync(fd) != 0)
+                    snapshot::fail("Failed to sync WAL " + path);
+            }
+            catch (const std::exception &e)
+            {
+                // Drop a torn or unsynced tail so replay never stops short of later records.
+                if (::ftruncate(fd, synced_end) == 0)
+                    ::lseek(fd, synced_end, SEEK_SET);
+                std::lock_guard<std::mutex> lock(batch_mutex);
+                pending.insert(pending.end(), batch.begin(), batch.end());
+                batch.swap(pending);
+                batch_start = pending_start;
+                failure = e.what();
+                throw;
+            }
+            synced_end += static_cast<off_t>(pending.size());
+        }
+
+        /**
+         * @brief Discards every record and restarts the log on top of a checkpointed version.
+         *
+         * @param version The version captured by the checkpoint snapshot.
+         * @throws std::runtime_error on I/O failure, or if an earlier commit failed.
+         */
+        void reset(uint64_t version)
+        {
+            std::lock_guard<std::mutex> io_lock(io_mutex);
+            {
+                std::lock_guard<std::mutex> lock(batch_mutex);
+                check_failure();
+                batch.clear();
+            }
+            header.base_version = version;
+            if (::ftruncate(fd, sizeof(Header)) != 0)
+                snapshot::fail("Failed to truncate WAL " + path);
+            write_header();
+            if (::fdatasync(fd) != 0)
+                snapshot::fail("Failed to sync WAL " + path);
+            synced_end = ::lseek(fd, 0, SEEK_END);
+        }
+    };
+
+}
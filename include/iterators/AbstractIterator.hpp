@@ -1,7 +1,12 @@
 // Author : noapatito123@gmail.com
 #pragma once
 #include <vector>
+#include <memory>
 #include <stdexcept>
+#include <chrono>
+
+#include "../ContainerStats.hpp"
+#include "../Trace.hpp"
 
 namespace containers
 {
@@ -25,9 +30,45 @@ namespace containers
     {
     protected:
         const MyContainer<T> &container; // Reference to the container being iterated.
-        std::vector<size_t> indices;     // A list of indices defining the order of iteration.
+        std::shared_ptr<const std::vector<size_t>> indices; // Indices defining the order of iteration, shared with the container's cache.
         size_t current;                  // Current position in the indices vector.
         size_t expected_index;           // Version of the container at the time of iterator creation.
+#ifdef MYCONTAINER_STATS
+        std::chrono::steady_clock::time_point build_start; // Set when the container reports build latencies.
+#endif
+
+        /**
+         * @brief Called by each concrete iterator once its indices are set; feeds the container's stats.
+         *
+         * @param order The order this iterator walks.
+         */
+        void record_construction(Order order)
+        {
+#ifdef MYCONTAINER_STATS
+            uint64_t build_ns = 0;
+            if (container.counters.timed())
+                build_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                     std::chrono::steady_clock::now() - build_start)
+                                                     .count());
+            container.counters.record_iterator(order, build_ns);
+#else
+            (void)order;
+#endif
+        }
+
+        /**
+         * @brief Throws the concurrent-modification error if the container changed since construction.
+         */
+        void check_version() const
+        {
+            if (expected_index != container.version())
+            {
+#ifdef MYCONTAINER_STATS
+                container.counters.record_modification_error();
+#endif
+                throw std::runtime_error("Container was modified during iteration");
+            }
+        }
 
     public:
         /**
@@ -36,7 +77,13 @@ namespace containers
          * @param cont The container to iterate over.
          */
         AbstractIterator(const MyContainer<T> &cont)
-            : container(cont), current(0), expected_index(cont.index) {}
+            : container(cont), current(0), expected_index(cont.version())
+        {
+#ifdef MYCONTAINER_STATS
+            if (container.counters.timed())
+                build_start = std::chrono::steady_clock::now();
+#endif
+        }
 
         virtual ~AbstractIterator() = default; // Virtual destructor.
 
@@ -49,15 +96,12 @@ namespace containers
          */
         const T &operator*() const
         {
-            if (expected_index != container.index)
-            {
-                throw std::runtime_error("Container was modified during iteration");
-            }
-            if (indices.empty() || current >= indices.size())
+            check_version();
+            if (!indices || current >= indices->size())
             {
                 throw std::out_of_range("Iterator out of bounds");
             }
-            return container.data[indices[current]];
+            return container.get_data()[(*indices)[current]];
         }
 
         /**
@@ -69,11 +113,8 @@ namespace containers
          */
         AbstractIterator &operator++()
         {
-            if (expected_index != container.index)
-            {
-                throw std::runtime_error("Container was modified during iteration");
-            }
-            if (indices.empty() || current >= indices.size())
+            check_version();
+            if (!indices || current >= indices->size())
             {
                 throw std::out_of_range("Iterator out of bounds");
             }
@@ -4,6 +4,7 @@
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
+#include <type_traits>
 
 namespace containers
 {
@@ -29,6 +30,18 @@ namespace containers
     private:
         const MyContainer<T> &container; // Reference to the container to be iterated.
 
+        /**
+         * @brief Returns the (absolute) difference hi - lo for hi >= lo, without signed overflow.
+         */
+        static auto distance(const T &hi, const T &lo)
+        {
+            if constexpr (std::is_integral<T>::value)
+                return static_cast<std::make_unsigned_t<T>>(static_cast<std::make_unsigned_t<T>>(hi) -
+                                                            static_cast<std::make_unsigned_t<T>>(lo));
+            else
+                return hi - lo;
+        }
+
     public:
         /**
          * @brief Constructs an AscendingOrder wrapper for the given container.
@@ -38,6 +51,19 @@ namespace containers
         AscendingOrder(const MyContainer<T> &cont)
             : container(cont) {}
 
+        /**
+         * @brief Returns a copy of the container's cached ascending permutation (sorted once per version).
+         *
+         * @param cont The container to iterate over.
+         * @return std::vector<size_t> Indices into the container's data, in iteration order.
+         */
+        static std::vector<size_t> build_indices(const MyContainer<T> &cont)
+        {
+            if (cont.size() == 0)
+                return {};
+            return *cont.sorted_indices();
+        }
+
         /**
          * @brief Iterator class for ascending order.
          */
@@ -47,7 +73,7 @@ namespace containers
             /**
              * @brief Constructs an ascending iterator.
              *
-             * Sorts the indices of the container elements in increasing order.
+             * Uses the container's cached ascending permutation of indices (sorted once per version).
              *
              * @param cont The container to iterate over.
              * @param is_end If true, initializes to the end iterator.
@@ -55,22 +81,27 @@ namespace containers
             Iterator(const MyContainer<T> &cont, bool is_end = false)
                 : AbstractIterator<T>(cont)
             {
-                const auto &data = cont.get_data();
-                size_t n = data.size();
-                if (n == 0)
-                    return;
-                this->indices.resize(n);
-                for (size_t i = 0; i < n; ++i)
-                    this->indices[i] = i;
-
-                std::sort(this->indices.begin(), this->indices.end(),
-                          [&](size_t a, size_t b)
-                          {
-                              return data[a] < data[b];
-                          });
+                trace::Scope trace_scope("AscendingOrder::Iterator", "iterator", cont.size());
+                this->indices = cont.order_permutation(Order::Ascending);
+                this->record_construction(Order::Ascending);
 
                 if (is_end)
-                    this->current = n;
+                    this->current = this->indices->size();
+            }
+
+            /**
+             * @brief Constructs an ascending iterator at a given position of an already fetched permutation.
+             *
+             * @param cont The container to iterate over.
+             * @param sorted The container's ascending permutation for its current version.
+             * @param position Zero-based position in ascending order (sorted->size() for the end).
+             */
+            Iterator(const MyContainer<T> &cont, std::shared_ptr<const std::vector<size_t>> sorted, size_t position)
+                : AbstractIterator<T>(cont)
+            {
+                this->indices = std::move(sorted);
+                this->current = position;
+                this->record_construction(Order::Ascending);
             }
 
             /**
@@ -84,6 +115,128 @@ namespace containers
             }
         };
 
+        /**
+         * @brief A contiguous run of the ascending order, [begin(), end()).
+         *
+         * Both ends share the container's cached permutation, so a Range costs two binary
+         * searches to create and nothing per element beyond a normal ascending iteration.
+         * Like any iterator, it throws if the container is modified while in use.
+         */
+        class Range
+        {
+        private:
+            Iterator first; // First element of the run.
+            Iterator last;  // One past the last element of the run.
+            size_t count;   // Number of elements in the run.
+
+        public:
+            Range(Iterator first_it, Iterator last_it, size_t n)
+                : first(std::move(first_it)), last(std::move(last_it)), count(n) {}
+
+            /**
+             * @brief Returns an iterator to the smallest element of the run.
+             */
+            Iterator begin() const
+            {
+                return first;
+            }
+
+            /**
+             * @brief Returns an iterator past the largest element of the run.
+             */
+            Iterator end() const
+            {
+                return last;
+            }
+
+            /**
+             * @brief Returns the number of elements in the run.
+             */
+            size_t size() const
+            {
+                return count;
+            }
+
+            /**
+             * @brief Tells whether the run is empty.
+             */
+            bool empty() const
+            {
+                return count == 0;
+            }
+        };
+
+        /**
+         * @brief Returns an iterator to the first element not less than value (end() if there is none).
+         *
+         * Binary search over the cached ascending permutation (sorted first if needed): O(log n).
+         *
+         * @param value The value to search for.
+         * @return Iterator Iterator into the ascending order; iterate to end() for every element >= value.
+         */
+        Iterator lower_bound(const T &value) const
+        {
+            auto sorted = container.sorted_indices();
+            size_t pos = container.sorted_lower_bound(*sorted, value);
+            return Iterator(container, std::move(sorted), pos);
+        }
+
+        /**
+         * @brief Returns an iterator to the first element greater than value (end() if there is none).
+         *
+         * Binary search over the cached ascending permutation (sorted first if needed): O(log n).
+         *
+         * @param value The value to search for.
+         * @return Iterator Iterator into the ascending order; iterate to end() for every element > value.
+         */
+        Iterator upper_bound(const T &value) const
+        {
+            auto sorted = container.sorted_indices();
+            size_t pos = container.sorted_upper_bound(*sorted, value);
+            return Iterator(container, std::move(sorted), pos);
+        }
+
+        /**
+         * @brief Returns the elements x with lo <= x <= hi, in ascending order.
+         *
+         * Two binary searches over the cached ascending permutation: O(log n), independent of
+         * the number of elements in the range. The range is empty when hi < lo.
+         *
+         * @param lo Inclusive lower bound.
+         * @param hi Inclusive upper bound.
+         * @return Range The matching run.
+         */
+        Range between(const T &lo, const T &hi) const
+        {
+            auto sorted = container.sorted_indices();
+            size_t first = container.sorted_lower_bound(*sorted, lo);
+            size_t last = hi < lo ? first : container.sorted_upper_bound(*sorted, hi);
+            return Range(Iterator(container, sorted, first), Iterator(container, sorted, last), last - first);
+        }
+
+        /**
+         * @brief Returns an iterator to the element closest to value (end() if the container is empty).
+         *
+         * Looks at the neighbours of lower_bound(value); on a tie the smaller element wins.
+         * Requires an arithmetic T, whose difference measures closeness.
+         *
+         * @param value The value to approach.
+         * @return Iterator Iterator into the ascending order at the nearest element.
+         */
+        Iterator nearest(const T &value) const
+        {
+            static_assert(std::is_arithmetic<T>::value, "nearest() requires an arithmetic element type");
+            auto sorted = container.sorted_indices();
+            size_t pos = container.sorted_lower_bound(*sorted, value);
+            if (pos > 0)
+            {
+                const auto &data = container.get_data();
+                if (pos == sorted->size() || distance(value, data[(*sorted)[pos - 1]]) <= distance(data[(*sorted)[pos]], value))
+                    --pos;
+            }
+            return Iterator(container, std::move(sorted), pos);
+        }
+
         /**
          * @brief Returns an iterator pointing to the beginning (smallest element).
          *
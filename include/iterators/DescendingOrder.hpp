@@ -34,6 +34,20 @@ namespace containers
         DescendingOrder(const MyContainer<T> &cont)
             : container(cont) {}
 
+        /**
+         * @brief Walks the container's cached ascending permutation of indices backwards.
+         *
+         * @param cont The container to iterate over.
+         * @return std::vector<size_t> Indices into the container's data, in iteration order.
+         */
+        static std::vector<size_t> build_indices(const MyContainer<T> &cont)
+        {
+            if (cont.size() == 0)
+                return {};
+            const auto &sorted = *cont.sorted_indices();
+            return std::vector<size_t>(sorted.rbegin(), sorted.rend());
+        }
+
         /**
          * @brief Iterator class for descending order.
          */
@@ -43,7 +57,7 @@ namespace containers
             /**
              * @brief Constructs a descending iterator.
              *
-             * Sorts the indices of the container elements in decreasing order.
+             * Walks the container's cached ascending permutation of indices backwards.
              *
              * @param cont The container to iterate over.
              * @param is_end If true, initializes the iterator to the end position.
@@ -51,22 +65,12 @@ namespace containers
             Iterator(const MyContainer<T> &cont, bool is_end = false)
                 : AbstractIterator<T>(cont)
             {
-                const auto &data = cont.get_data();
-                size_t n = data.size();
-                if (n == 0)
-                    return;
-                this->indices.resize(n);
-                for (size_t i = 0; i < n; ++i)
-                    this->indices[i] = i;
-
-                std::sort(this->indices.begin(), this->indices.end(),
-                          [&](size_t a, size_t b)
-                          {
-                              return data[a] > data[b];
-                          });
+                trace::Scope trace_scope("DescendingOrder::Iterator", "iterator", cont.size());
+                this->indices = cont.order_permutation(Order::Descending);
+                this->record_construction(Order::Descending);
 
                 if (is_end)
-                    this->current = n;
+                    this->current = this->indices->size();
             }
 
             /**
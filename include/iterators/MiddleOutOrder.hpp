@@ -35,6 +35,41 @@ namespace containers
         MiddleOutOrder(const MyContainer<T> &cont)
             : container(cont) {}
 
+        /**
+         * @brief Starts from the middle index and expands outward by alternating left and right.
+         *
+         * @param cont The container to iterate over.
+         * @return std::vector<size_t> Indices into the container's data, in iteration order.
+         */
+        static std::vector<size_t> build_indices(const MyContainer<T> &cont)
+        {
+            std::vector<size_t> indices;
+            size_t n = cont.size();
+            if (n == 0)
+                return indices;
+            indices.reserve(n);
+            int mid = static_cast<int>(n) / 2;
+            int left = mid - 1;
+            int right = mid + 1;
+
+            indices.push_back(mid);
+            bool go_left = true;
+
+            while (left >= 0 || right < static_cast<int>(n))
+            {
+                if (go_left && left >= 0)
+                {
+                    indices.push_back(left--);
+                }
+                else if (!go_left && right < static_cast<int>(n))
+                {
+                    indices.push_back(right++);
+                }
+                go_left = !go_left;
+            }
+            return indices;
+        }
+
         /**
          * @brief Iterator class for middle-out order.
          */
@@ -52,32 +87,12 @@ namespace containers
             Iterator(const MyContainer<T> &cont, bool is_end = false)
                 : AbstractIterator<T>(cont)
             {
-                const auto &data = cont.get_data();
-                size_t n = data.size();
-                if (n == 0)
-                    return;
-                int mid = static_cast<int>(n) / 2;
-                int left = mid - 1;
-                int right = mid + 1;
-
-                this->indices.push_back(mid);
-                bool go_left = true;
-
-                while (left >= 0 || right < static_cast<int>(n))
-                {
-                    if (go_left && left >= 0)
-                    {
-                        this->indices.push_back(left--);
-                    }
-                    else if (!go_left && right < static_cast<int>(n))
-                    {
-                        this->indices.push_back(right++);
-                    }
-                    go_left = !go_left;
-                }
+                trace::Scope trace_scope("MiddleOutOrder::Iterator", "iterator", cont.size());
+                this->indices = cont.order_permutation(Order::MiddleOut);
+                this->record_construction(Order::MiddleOut);
 
                 if (is_end)
-                    this->current = this->indices.size();
+                    this->current = this->indices->size();
             }
 
             /**
@@ -34,6 +34,20 @@ namespace containers
         RegularOrder(const MyContainer<T> &cont)
             : container(cont) {}
 
+        /**
+         * @brief Builds the insertion-order sequence of indices: 0, 1, ..., n-1.
+         *
+         * @param cont The container to iterate over.
+         * @return std::vector<size_t> Indices into the container's data, in iteration order.
+         */
+        static std::vector<size_t> build_indices(const MyContainer<T> &cont)
+        {
+            std::vector<size_t> indices(cont.size());
+            for (size_t i = 0; i < indices.size(); ++i)
+                indices[i] = i;
+            return indices;
+        }
+
         /**
          * @brief Iterator class for regular (insertion) order.
          */
@@ -51,16 +65,12 @@ namespace containers
             Iterator(const MyContainer<T> &cont, bool is_end = false)
                 : AbstractIterator<T>(cont)
             {
-                const auto &data = cont.get_data();
-                size_t n = data.size();
-                if (n == 0)
-                    return;
-                this->indices.resize(n);
-                for (size_t i = 0; i < n; ++i)
-                    this->indices[i] = i;
+                trace::Scope trace_scope("RegularOrder::Iterator", "iterator", cont.size());
+                this->indices = cont.order_permutation(Order::Regular);
+                this->record_construction(Order::Regular);
 
                 if (is_end)
-                    this->current = n;
+                    this->current = this->indices->size();
             }
 
             /**
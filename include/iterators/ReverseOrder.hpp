@@ -35,6 +35,21 @@ namespace containers
         ReverseOrder(const MyContainer<T> &cont)
             : container(cont) {}
 
+        /**
+         * @brief Builds the reverse insertion-order sequence of indices: n-1, ..., 1, 0.
+         *
+         * @param cont The container to iterate over.
+         * @return std::vector<size_t> Indices into the container's data, in iteration order.
+         */
+        static std::vector<size_t> build_indices(const MyContainer<T> &cont)
+        {
+            size_t n = cont.size();
+            std::vector<size_t> indices(n);
+            for (size_t i = 0; i < n; ++i)
+                indices[i] = n - 1 - i;
+            return indices;
+        }
+
         /**
          * @brief Iterator class for reverse insertion order.
          */
@@ -52,16 +67,12 @@ namespace containers
             Iterator(const MyContainer<T> &cont, bool is_end = false)
                 : AbstractIterator<T>(cont)
             {
-                const auto &data = cont.get_data();
-                size_t n = data.size();
-                if (n == 0)
-                    return;
-                this->indices.resize(n);
-                for (size_t i = 0; i < n; ++i)
-                    this->indices[i] = n - 1 - i;
+                trace::Scope trace_scope("ReverseOrder::Iterator", "iterator", cont.size());
+                this->indices = cont.order_permutation(Order::Reverse);
+                this->record_construction(Order::Reverse);
 
                 if (is_end)
-                    this->current = n;
+                    this->current = this->indices->size();
             }
 
             /**
@@ -36,6 +36,39 @@ namespace containers
         SideCrossOrder(const MyContainer<T> &cont)
             : container(cont) {}
 
+        /**
+         * @brief Takes the container's cached ascending permutation, then creates a zigzag traversal
+         * pattern: first element, last, second, second-to-last, and so on.
+         *
+         * @param cont The container to iterate over.
+         * @return std::vector<size_t> Indices into the container's data, in iteration order.
+         */
+        static std::vector<size_t> build_indices(const MyContainer<T> &cont)
+        {
+            std::vector<size_t> indices;
+            size_t n = cont.size();
+            if (n == 0)
+                return indices;
+            const auto &temp = *cont.sorted_indices();
+            indices.reserve(n);
+
+            size_t left = 0, right = n - 1;
+            while (left <= right)
+            {
+                if (left == right)
+                    indices.push_back(temp[left]);
+                else
+                {
+                    indices.push_back(temp[left]);
+                    indices.push_back(temp[right]);
+                }
+                ++left;
+                if (right > 0)
+                    --right;
+            }
+            return indices;
+        }
+
         /**
          * @brief Iterator class for side-cross order.
          */
@@ -45,7 +78,7 @@ namespace containers
             /**
              * @brief Constructs a side-cross iterator.
              *
-             * Sorts the elements in ascending order, then creates a zigzag traversal
+             * Takes the container's cached ascending permutation, then creates a zigzag traversal
              * pattern: first element, last, second, second-to-last, and so on.
              *
              * @param cont The container to iterate over.
@@ -54,37 +87,12 @@ namespace containers
             Iterator(const MyContainer<T> &cont, bool is_end = false)
                 : AbstractIterator<T>(cont)
             {
-                const auto &data = cont.get_data();
-                size_t n = data.size();
-                if (n == 0)
-                    return;
-                std::vector<size_t> temp(n);
-                for (size_t i = 0; i < n; ++i)
-                    temp[i] = i;
-
-                std::sort(temp.begin(), temp.end(),
-                          [&](size_t a, size_t b)
-                          {
-                              return data[a] < data[b];
-                          });
-
-                size_t left = 0, right = n - 1;
-                while (left <= right)
-                {
-                    if (left == right)
-                        this->indices.push_back(temp[left]);
-                    else
-                    {
-                        this->indices.push_back(temp[left]);
-                        this->indices.push_back(temp[right]);
-                    }
-                    ++left;
-                    if (right > 0)
-                        --right;
-                }
+                trace::Scope trace_scope("SideCrossOrder::Iterator", "iterator", cont.size());
+                this->indices = cont.order_permutation(Order::SideCross);
+                this->record_construction(Order::SideCross);
 
                 if (is_end)
-                    this->current = this->indices.size();
+                    this->current = this->indices->size();
             }
 
             /**
@@ -0,0 +1,78 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+/**
+ * Replaces the global operator new/delete with malloc/free wrappers that count the
+ * allocations made by the calling thread. Include from exactly one translation unit
+ * (replacement allocation functions must be defined once per program).
+ */
+
+namespace alloc_counter
+{
+    inline thread_local size_t allocations = 0; // operator new calls made by this thread.
+
+    /**
+     * @brief Counts the allocations made by the current thread during its lifetime.
+     */
+    class Scope
+    {
+    private:
+        size_t start = allocations; // Counter value at construction.
+
+    public:
+        /**
+         * @brief Returns the number of allocations since construction.
+         */
+        size_t count() const
+        {
+            return allocations - start;
+        }
+    };
+}
+
+// GCC pairs the std::free calls below with the inlined operator new and warns
+// (-Wmismatched-new-delete) from -O1 on; both sides use malloc/free, so it is a false positive.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t size)
+{
+    ++alloc_counter::allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
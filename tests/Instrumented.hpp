@@ -0,0 +1,87 @@
+// Author : noapatito123@gmail.com
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <functional>
+
+/**
+ * @brief Operation counts of Instrumented since the last Instrumented::reset().
+ */
+struct InstrumentedCounts
+{
+    size_t less = 0;   // operator< calls.
+    size_t equal = 0;  // operator== calls.
+    size_t copies = 0; // Copy constructions and copy assignments.
+    size_t moves = 0;  // Move constructions and move assignments.
+    size_t hashes = 0; // std::hash<Instrumented> calls.
+};
+
+/**
+ * @brief Element wrapper that counts the operations containers perform on it.
+ *
+ * Counters are global (shared by all instances) and not thread-safe; use it from
+ * single-threaded tests and reset() before each measured step.
+ */
+struct Instrumented
+{
+    inline static InstrumentedCounts counts; // Shared by all instances.
+
+    int value = 0; // The wrapped key.
+
+    /**
+     * @brief Zeroes every counter.
+     */
+    static void reset()
+    {
+        counts = InstrumentedCounts{};
+    }
+
+    Instrumented() = default;
+    Instrumented(int v) : value(v) {}
+    Instrumented(const Instrumented &other) : value(other.value) { ++counts.copies; }
+    Instrumented(Instrumented &&other) noexcept : value(other.value) { ++counts.moves; }
+
+    Instrumented &operator=(const Instrumented &other)
+    {
+        value = other.value;
+        ++counts.copies;
+        return *this;
+    }
+
+    Instrumented &operator=(Instrumented &&other) noexcept
+    {
+        value = other.value;
+        ++counts.moves;
+        return *this;
+    }
+
+    friend bool operator<(const Instrumented &a, const Instrumented &b)
+    {
+        ++counts.less;
+        return a.value < b.value;
+    }
+
+    friend bool operator==(const Instrumented &a, const Instrumented &b)
+    {
+        ++counts.equal;
+        return a.value == b.value;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Instrumented &x)
+    {
+        return os << x.value;
+    }
+};
+
+namespace std
+{
+    template <>
+    struct hash<Instrumented>
+    {
+        size_t operator()(const Instrumented &x) const
+        {
+            ++Instrumented::counts.hashes;
+            return std::hash<int>()(x.value);
+        }
+    };
+}
@@ -1,8 +1,31 @@
 // Author : noapatito123@gmail.com
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define MYCONTAINER_STATS
 #include "doctest.h"
 #include "../include/MyContainer.hpp"
+#include "../include/ConcurrentMyContainer.hpp"
+#include "../include/MappedContainer.hpp"
+#include "../include/DurableContainer.hpp"
+#include "../include/Workloads.hpp"
+#include "AllocationCounter.hpp"
+#include "Instrumented.hpp"
 #include <sstream>
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <csignal>
+#include <chrono>
 
 using namespace containers;
 
@@ -142,5 +165,1352 @@ TEST_CASE("Iterator throws when incremented past end") {
     CHECK_THROWS(++it);
 }
 
+TEST_CASE("Concurrent container allows parallel readers while writing") {
+    ConcurrentMyContainer<int> c;
+    for (int i = 0; i < 100; ++i)
+        c.add(i);
 
+    std::vector<std::thread> readers;
+    std::vector<int> ok(4, 1);
+    for (size_t r = 0; r < ok.size(); ++r) {
+        readers.emplace_back([&c, &ok, r]() {
+            for (int round = 0; round < 50; ++round) {
+                c.read([&](const MyContainer<int>& view) {
+                    size_t seen = 0;
+                    int prev = -1;
+                    for (auto val : view.Ascending()) {
+                        if (val < prev) ok[r] = 0;
+                        prev = val;
+                        ++seen;
+                    }
+                    if (seen != view.size()) ok[r] = 0;
+                });
+            }
+        });
+    }
+    for (int i = 100; i < 200; ++i)
+        c.add(i);
+    for (auto& t : readers)
+        t.join();
 
+    for (int flag : ok)
+        CHECK(flag == 1);
+    CHECK(c.size() == 200);
+    c.remove(0);
+    CHECK(c.size() == 199);
+    CHECK_THROWS_WITH(c.remove(0), "Element was not found");
+    CHECK(c.write([](MyContainer<int>& m) { m.add(-1); return m.size(); }) == 200);
+}
+
+TEST_CASE("Pinned snapshot iterates safely while writers proceed") {
+    ConcurrentMyContainer<int> c;
+    c.add(3);
+    c.add(1);
+    c.add(2);
+
+    auto snap = c.pin();
+    CHECK(c.pin() == snap); // same epoch is shared until the next write
+
+    std::vector<int> seen;
+    for (auto val : snap->Ascending()) {
+        c.add(val + 10); // would throw on a live container
+        seen.push_back(val);
+    }
+    CHECK(seen == std::vector<int>{1, 2, 3});
+    CHECK(snap->size() == 3);
+
+    auto next = c.pin();
+    CHECK(next != snap);
+    CHECK(next->size() == 6);
+    CHECK(next->version() == c.read([](const MyContainer<int>& m) { return m.version(); }));
+
+    // Replacing the container can keep its version while changing its contents.
+    ConcurrentMyContainer<int> d;
+    d.add(1);
+    d.add(2);
+    auto before = d.pin();
+    d.write([](MyContainer<int>& m) {
+        MyContainer<int> other;
+        other.add(7);
+        other.add(8);
+        m = other; // same version as before, different elements
+    });
+    auto after = d.pin();
+    CHECK(after != before);
+    CHECK(after->get_data() == std::vector<int>{7, 8});
+}
+
+TEST_CASE("Writers reuse state released by pinned readers without racing") {
+    ConcurrentMyContainer<int> c;
+    for (int i = 0; i < 64; ++i)
+        c.add(i);
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r)
+        readers.emplace_back([&]()
+                             {
+                                 while (!done.load())
+                                 {
+                                     auto snap = c.pin();
+                                     long long sum = 0;
+                                     for (int v : snap->Ascending())
+                                         sum += v;
+                                     for (int v : snap->MiddleOut())
+                                         sum -= v;
+                                     if (sum != 0)
+                                         consistent = false;
+                                 } });
+    for (int i = 0; i < 2000; ++i)
+        c.add(i); // detaches while an epoch is pinned, reuses in place once readers let go
+    done = true;
+    for (auto &t : readers)
+        t.join();
+    CHECK(consistent);
+    CHECK(c.size() == 2064);
+}
+
+TEST_CASE("Copies share storage until one of them is written") {
+    MyContainer<int> a;
+    a.add(4);
+    a.add(2);
+    a.add(9);
+    for (auto val : a.Ascending()) (void)val; // populate the sorted cache
+
+    MyContainer<int> b = a;
+    CHECK(&b.get_data() == &a.get_data());
+    CHECK(b.sorted_indices() == a.sorted_indices());
+
+    b.add(1);
+    CHECK(&b.get_data() != &a.get_data());
+    CHECK(a.size() == 3);
+    CHECK(b.size() == 4);
+    check_iterator(a, {2, 4, 9}, "Ascending");
+    check_iterator(b, {1, 2, 4, 9}, "Ascending");
+    check_iterator(b, {9, 4, 2, 1}, "Descending");
+
+    MyContainer<int> c;
+    c = a;
+    c.remove(4);
+    check_iterator(a, {4, 2, 9}, "Regular");
+    check_iterator(c, {2, 9}, "Regular");
+    CHECK_THROWS_WITH(c.remove(4), "Element was not found");
+}
+
+TEST_CASE("Sharded ingestion merges on flush and on read") {
+    ConcurrentMyContainer<int> c(4);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&c, t]() {
+            for (int i = 0; i < 500; ++i)
+                c.ingest(t * 1000 + i);
+        });
+    }
+    for (auto& p : producers)
+        p.join();
+
+    CHECK(c.size() == 2000); // merged by the read
+    c.read([](const MyContainer<int>& m) {
+        std::vector<int> last(4, -1);
+        bool ordered = true;
+        for (auto val : m.Regular()) {
+            if (val % 1000 != last[val / 1000] + 1) ordered = false; // each producer keeps its order
+            last[val / 1000] = val % 1000;
+        }
+        CHECK(ordered);
+    });
+
+    c.ingest(-5);
+    c.flush();
+    CHECK(c.read([](const MyContainer<int>& m) { return m.get_data().back(); }) == -5);
+    c.ingest(-6);
+    CHECK_NOTHROW(c.remove(-6));
+    CHECK(c.size() == 2001);
+}
+
+TEST_CASE("parallel_for_each visits every element of every order once") {
+    MyContainer<int> c;
+    for (int i = 1; i <= 1000; ++i)
+        c.add(i % 37);
+    long expected = 0;
+    for (auto val : c.Regular())
+        expected += val;
+
+    WorkStealingPool pool(3);
+    CHECK(pool.size() == 3);
+    for (Order order : {Order::Ascending, Order::Descending, Order::SideCross,
+                        Order::Reverse, Order::Regular, Order::MiddleOut}) {
+        std::atomic<long> sum{0};
+        std::atomic<size_t> visits{0};
+        c.parallel_for_each(order, [&](const int& val) {
+            sum += val;
+            ++visits;
+        }, pool);
+        CHECK(visits == c.size());
+        CHECK(sum == expected);
+    }
+
+    std::atomic<size_t> on_shared_pool{0};
+    c.parallel_for_each(Order::Regular, [&](const int&) { ++on_shared_pool; });
+    CHECK(on_shared_pool == 1000);
+
+    CHECK_THROWS_WITH(c.parallel_for_each(Order::Ascending, [](const int& val) {
+        if (val == 36) throw std::runtime_error("boom");
+    }, pool), "boom");
+
+    MyContainer<int> empty;
+    CHECK_NOTHROW(empty.parallel_for_each(Order::SideCross, [](const int&) {}, pool));
+}
+
+TEST_CASE("Reductions over the data buffer") {
+    MyContainer<int> c;
+    CHECK(c.sum() == 0);
+    CHECK(c.count_if([](int) { return true; }) == 0);
+    CHECK_THROWS_WITH(c.min(), "Container is empty");
+    CHECK_THROWS_WITH(c.max(), "Container is empty");
+    CHECK_THROWS_WITH(c.mean(), "Container is empty");
+
+    long long expected = 0;
+    for (int i = 0; i < 1037; ++i) {
+        int val = (i * 7919) % 2003 - 1000;
+        c.add(val);
+        expected += val;
+    }
+    c.add(2000000000);
+    c.add(2000000000); // would overflow a 32-bit accumulator
+    expected += 4000000000LL;
+
+    CHECK(c.sum() == expected);
+    CHECK(c.min() == -1000);
+    CHECK(c.max() == 2000000000);
+    CHECK(c.mean() == doctest::Approx(static_cast<double>(expected) / 1039));
+    CHECK(c.count_if([](int val) { return val < 0; }) ==
+          static_cast<size_t>(std::count_if(c.get_data().begin(), c.get_data().end(), [](int val) { return val < 0; })));
+
+    MyContainer<double> d;
+    for (int i = 1; i <= 101; ++i)
+        d.add(i * 0.5);
+    CHECK(d.sum() == doctest::Approx(2575.5));
+    CHECK(d.min() == 0.5);
+    CHECK(d.max() == 50.5);
+    CHECK(d.mean() == doctest::Approx(25.5));
+
+    MyContainer<std::string> s;
+    s.add("b");
+    s.add("a");
+    s.add("c");
+    s.add("d");
+    s.add("e");
+    CHECK(s.sum() == "bacde");
+    CHECK(s.min() == "a");
+    CHECK(s.max() == "e");
+}
+
+TEST_CASE("SIMD reductions match the scalar kernels, tails included") {
+    using namespace containers::reductions;
+    if (!avx2_available())
+        MESSAGE("AVX2 not available: the dispatching kernels fall back to the scalar ones");
+
+    // Sizes 0..70 cover every tail length of the 4-, 8- and 16-wide loops.
+    for (size_t n = 0; n <= 70; ++n) {
+        std::vector<int> ints(n);
+        std::vector<float> floats(n);
+        std::vector<double> doubles(n);
+        for (size_t i = 0; i < n; ++i) {
+            int val = static_cast<int>((i * 7919 + n * 31) % 2003) - 1000;
+            ints[i] = val;
+            floats[i] = static_cast<float>(val); // small integers: float sums stay exact
+            doubles[i] = val * 0.25;
+        }
+        CHECK(sum_kernel(ints.data(), n) == sum_scalar(ints.data(), n));
+        CHECK(sum_kernel(floats.data(), n) == sum_scalar(floats.data(), n));
+        CHECK(sum_kernel(doubles.data(), n) == doctest::Approx(sum_scalar(doubles.data(), n)));
+        if (n == 0)
+            continue;
+
+        // The extremes sit in the tail, past the last full vector.
+        ints[n - 1] = std::numeric_limits<int>::min();
+        floats[n - 1] = 1e30f;
+        doubles[n - 1] = -1e300;
+        CHECK(extreme_kernel<true>(ints.data(), n) == std::numeric_limits<int>::min());
+        CHECK(extreme_kernel<true>(ints.data(), n) == extreme_scalar<true>(ints.data(), n));
+        CHECK(extreme_kernel<false>(ints.data(), n) == extreme_scalar<false>(ints.data(), n));
+        CHECK(extreme_kernel<false>(floats.data(), n) == 1e30f);
+        CHECK(extreme_kernel<true>(floats.data(), n) == extreme_scalar<true>(floats.data(), n));
+        CHECK(extreme_kernel<false>(floats.data(), n) == extreme_scalar<false>(floats.data(), n));
+        CHECK(extreme_kernel<true>(doubles.data(), n) == -1e300);
+        CHECK(extreme_kernel<true>(doubles.data(), n) == extreme_scalar<true>(doubles.data(), n));
+        CHECK(extreme_kernel<false>(doubles.data(), n) == extreme_scalar<false>(doubles.data(), n));
+    }
+
+    std::vector<int> big(1000, 2000000000); // 64-bit lanes: no overflow in the vector sum
+    CHECK(sum_kernel(big.data(), big.size()) == 2000000000LL * 1000);
+}
+
+TEST_CASE("Reductions split across the pool above the parallel threshold") {
+    using namespace containers::reductions;
+    WorkStealingPool pool(4);
+    const size_t n = parallel_threshold + 13;
+    std::vector<int> data(n);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = static_cast<int>((i * 7919) % 200003) - 100000;
+    data[n - 1] = -200000;
+    data[n / 2] = 300000;
+
+    auto plus = [](long long a, long long b) { return a + b; };
+    long long split_sum = reduce<long long>(data.data(), n, [](const int *p, size_t k) { return sum_kernel(p, k); }, plus, pool);
+    CHECK(split_sum == sum_scalar(data.data(), n));
+
+    auto smaller = [](int a, int b) { return b < a ? b : a; };
+    auto larger = [](int a, int b) { return a < b ? b : a; };
+    CHECK(reduce<int>(data.data(), n, [](const int *p, size_t k) { return extreme_kernel<true>(p, k); }, smaller, pool) == -200000);
+    CHECK(reduce<int>(data.data(), n, [](const int *p, size_t k) { return extreme_kernel<false>(p, k); }, larger, pool) == 300000);
+
+    auto negative = [](int val) { return val < 0; };
+    auto count_plus = [](size_t a, size_t b) { return a + b; };
+    CHECK(reduce<size_t>(data.data(), n, [&](const int *p, size_t k) { return count_kernel(p, k, negative); }, count_plus, pool) ==
+          static_cast<size_t>(std::count_if(data.begin(), data.end(), negative)));
+
+    // The container entry points agree on the same buffer (shared pool, split or not).
+    MyContainer<int> c;
+    for (int val : data)
+        c.add(val);
+    CHECK(c.sum() == split_sum);
+    CHECK(c.min() == -200000);
+    CHECK(c.max() == 300000);
+}
+
+TEST_CASE("Mapped container grows, iterates and survives reopening") {
+    std::string path = "/tmp/mycontainer_mapped_" + std::to_string(::getpid()) + ".bin";
+    std::remove(path.c_str());
+    {
+        MappedContainer<int> m(path);
+        CHECK(m.size() == 0);
+        for (int i = 0; i < 3000; ++i) // forces the file to grow past its initial capacity
+            m.add(i % 10);
+        CHECK(m.size() == 3000);
+        m.remove(9);
+        CHECK(m.size() == 2700);
+        CHECK_THROWS_WITH(m.remove(9), "Element was not found");
+
+        auto it = m.Regular().begin();
+        m.add(42);
+        CHECK_THROWS_WITH(*it, "Container was modified during iteration");
+        m.sync();
+    }
+    {
+        MappedContainer<int> m(path, AccessPattern::Random);
+        CHECK(m.size() == 2701);
+        std::vector<int> regular, reverse;
+        for (int val : m.Regular()) regular.push_back(val);
+        for (int val : m.Reverse()) reverse.push_back(val);
+        CHECK(regular.front() == 0);
+        CHECK(regular.back() == 42);
+        std::reverse(reverse.begin(), reverse.end());
+        CHECK(regular == reverse);
+        auto end = m.Regular().end();
+        CHECK_THROWS(++end);
+        m.advise(AccessPattern::WillNeed);
+    }
+    CHECK_THROWS(MappedContainer<double>(path)); // written for 4-byte elements
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Mapped container rejects corrupt headers") {
+    std::string path = "/tmp/mycontainer_mapped_corrupt_" + std::to_string(::getpid()) + ".bin";
+    auto write_header = [&](uint64_t count, uint64_t capacity)
+    {
+        std::remove(path.c_str());
+        {
+            MappedContainer<int> m(path);
+            m.add(1);
+        }
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(16); // count, then capacity
+        f.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        f.write(reinterpret_cast<const char *>(&capacity), sizeof(capacity));
+    };
+
+    write_header(1, 1024);
+    CHECK(MappedContainer<int>(path).size() == 1); // the untouched layout still opens
+    write_header(1025, 1024);
+    CHECK_THROWS_AS(MappedContainer<int>{path}, std::runtime_error); // count past capacity
+    write_header(0, 0);
+    CHECK_THROWS_AS(MappedContainer<int>{path}, std::runtime_error); // growth could never succeed
+    write_header(1, (std::numeric_limits<uint64_t>::max() >> 2) + 1);
+    CHECK_THROWS_AS(MappedContainer<int>{path}, std::runtime_error); // byte size overflows
+    std::remove(path.c_str());
+
+    // The error names the failing call's errno, not whatever closing the file left behind.
+    struct rlimit saved;
+    REQUIRE(::getrlimit(RLIMIT_FSIZE, &saved) == 0);
+    struct rlimit tight = saved;
+    tight.rlim_cur = 16;
+    auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+    REQUIRE(::setrlimit(RLIMIT_FSIZE, &tight) == 0);
+    std::string expected = "Failed to size mapped file " + path + ": " + std::strerror(EFBIG);
+    CHECK_THROWS_WITH(MappedContainer<int>{path}, expected.c_str());
+    REQUIRE(::setrlimit(RLIMIT_FSIZE, &saved) == 0);
+    std::signal(SIGXFSZ, old_handler);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("External merge sort keeps few files open and fails cleanly without descriptors") {
+    std::vector<int> values;
+    for (int i = 0; i < 100000; ++i)
+        values.push_back((i * 7919) % 100003);
+    std::vector<int> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    struct rlimit saved;
+    REQUIRE(::getrlimit(RLIMIT_NOFILE, &saved) == 0);
+    int probe = ::open("/dev/null", O_RDONLY); // lowest free descriptor
+    REQUIRE(probe >= 0);
+    ::close(probe);
+    struct rlimit limited = saved;
+    limited.rlim_cur = static_cast<rlim_t>(probe) + 32;
+    REQUIRE(::setrlimit(RLIMIT_NOFILE, &limited) == 0);
+    std::vector<int> result;
+    size_t runs = 0;
+    {
+        ExternalSortedRange<int> sorted(values.data(), values.size(), 64 * sizeof(int)); // 1563 runs
+        runs = sorted.run_count();
+        for (int val : sorted) result.push_back(val);
+    }
+    limited.rlim_cur = static_cast<rlim_t>(probe);
+    REQUIRE(::setrlimit(RLIMIT_NOFILE, &limited) == 0);
+    CHECK_THROWS_AS(ExternalSortedRange<int>(values.data(), values.size(), 64 * sizeof(int)), std::runtime_error);
+    REQUIRE(::setrlimit(RLIMIT_NOFILE, &saved) == 0);
+    CHECK(runs == 1563);
+    CHECK(result == expected);
+}
+
+TEST_CASE("External merge sort orders data within a memory budget") {
+    std::vector<int> values;
+    for (int i = 0; i < 5000; ++i)
+        values.push_back((i * 7919) % 1009);
+
+    ExternalSortedRange<int> asc(values.data(), values.size(), 256 * sizeof(int));
+    CHECK(asc.run_count() == 20);
+    std::vector<int> expected = values;
+    std::sort(expected.begin(), expected.end());
+    std::vector<int> result;
+    for (int val : asc) result.push_back(val);
+    CHECK(result == expected);
+
+    result.clear();
+    for (int val : asc) result.push_back(val); // a second pass restarts the merge
+    CHECK(result == expected);
+
+    ExternalSortedRange<int> desc(values.data(), values.size(), 1000 * sizeof(int), true);
+    std::reverse(expected.begin(), expected.end());
+    result.clear();
+    for (int val : desc) result.push_back(val);
+    CHECK(result == expected);
+
+    ExternalSortedRange<int> empty(values.data(), 0, 64);
+    CHECK(empty.begin() == empty.end());
+    CHECK_THROWS_AS(*empty.begin(), std::out_of_range);
+
+    CHECK(asc.fan_in() == 4); // 256 elements of budget / MIN_CHUNK
+    CHECK(asc.merge_count() > 1); // 20 runs need more than one merge pass
+    result.clear();
+    ExternalSortedRange<int> tiny(values.data(), values.size(), 3 * sizeof(int), true);
+    CHECK(tiny.fan_in() == 2);
+    for (int val : tiny) result.push_back(val);
+    CHECK(result == expected);
+
+    std::string path = "/tmp/mycontainer_extsort_" + std::to_string(::getpid()) + ".bin";
+    std::remove(path.c_str());
+    {
+        MappedContainer<double> m(path);
+        m.add(2.5);
+        m.add(-1.0);
+        m.add(7.25);
+        std::vector<double> sorted;
+        for (double val : m.Ascending(sizeof(double))) sorted.push_back(val);
+        CHECK(sorted == std::vector<double>{-1.0, 2.5, 7.25});
+        sorted.clear();
+        for (double val : m.Descending()) sorted.push_back(val);
+        CHECK(sorted == std::vector<double>{7.25, 2.5, -1.0});
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Binary snapshot save and load round-trip") {
+    std::string path = "/tmp/mycontainer_snapshot_" + std::to_string(::getpid()) + ".snap";
+    MyContainer<int> c;
+    for (int i = 0; i < 100; ++i)
+        c.add((i * 37) % 101);
+    c.remove(0);
+    c.save(path);
+
+    MyContainer<int> loaded = MyContainer<int>::load(path);
+    CHECK(loaded.get_data() == c.get_data());
+    CHECK(loaded.version() == c.version());
+    std::vector<int> sorted = c.get_data();
+    std::sort(sorted.begin(), sorted.end());
+    check_iterator(loaded, sorted, "Ascending");
+    CHECK_THROWS_WITH(loaded.remove(0), "Element was not found");
+    loaded.remove(36);
+    CHECK(loaded.size() == 98);
+
+    CHECK_THROWS(MyContainer<double>::load(path)); // element size mismatch
+    {
+        FILE* f = std::fopen(path.c_str(), "r+b");
+        std::fseek(f, 64, SEEK_SET);
+        std::fputc(0x7f, f); // corrupt the first element
+        std::fclose(f);
+    }
+    CHECK_THROWS_WITH(MyContainer<int>::load(path), ("Snapshot checksum mismatch: " + path).c_str());
+    CHECK_THROWS(MyContainer<int>::load(path + ".missing"));
+
+    MyContainer<int> empty;
+    empty.save(path);
+    CHECK(MyContainer<int>::load(path).size() == 0);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Snapshots persist the sorted permutation for reuse after load") {
+    std::string path = "/tmp/mycontainer_sorted_" + std::to_string(::getpid()) + ".snap";
+    MyContainer<double> c;
+    for (int i = 0; i < 50; ++i)
+        c.add((i * 13) % 17 + 0.5);
+
+    c.save(path); // nothing cached yet: no sorted section
+    CHECK_FALSE(MyContainer<double>::load(path).sorted_cached());
+
+    c.save(path, true);
+    CHECK(c.sorted_cached());
+    MyContainer<double> loaded = MyContainer<double>::load(path);
+    CHECK(loaded.sorted_cached());
+    CHECK(*loaded.sorted_indices() == *c.sorted_indices());
+    std::vector<double> expected = c.get_data();
+    std::sort(expected.begin(), expected.end());
+    check_iterator(loaded, expected, "Ascending");
+    loaded.add(0.0);
+    CHECK_FALSE(loaded.sorted_cached());
+
+    {
+        FILE* f = std::fopen(path.c_str(), "r+b");
+        std::fseek(f, -1, SEEK_END);
+        std::fputc(0x01, f); // damage the last permutation entry
+        std::fclose(f);
+    }
+    MyContainer<double> damaged = MyContainer<double>::load(path);
+    CHECK_FALSE(damaged.sorted_cached());
+    check_iterator(damaged, expected, "Ascending");
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Durable container replays its log and checkpoints") {
+    std::string prefix = "/tmp/mycontainer_durable_" + std::to_string(::getpid());
+    std::remove((prefix + ".snap").c_str());
+    std::remove((prefix + ".wal").c_str());
+    WalOptions options;
+    options.group_bytes = 64;                          // a commit every few records
+    options.group_delay = std::chrono::milliseconds(1);
+    {
+        DurableContainer<int> d(prefix, options, 0);
+        for (int i = 0; i < 20; ++i)
+            d.add(i);
+        d.remove(7);
+        CHECK_THROWS_WITH(d.remove(7), "Element was not found");
+    } // destructor commits the tail of the last batch
+    {
+        DurableContainer<int> d(prefix, options, 0);
+        d.view().save(prefix + ".snap"); // as if we crashed between snapshot and log reset
+    }
+    {
+        DurableContainer<int> d(prefix, options, 0);
+        CHECK(d.size() == 19);
+        d.checkpoint();
+        d.add(100);
+        d.sync();
+    }
+    {
+        DurableContainer<int> d(prefix, options, 5);
+        CHECK(d.size() == 20);
+        CHECK(d.view().get_data().back() == 100);
+        for (int i = 0; i < 6; ++i) // crosses the automatic checkpoint
+            d.add(200 + i);
+    }
+    {
+        FILE* f = std::fopen((prefix + ".wal").c_str(), "ab");
+        std::fputc(0x01, f); // torn half-record at the tail
+        std::fclose(f);
+        DurableContainer<int> d(prefix, options, 0);
+        CHECK(d.size() == 26);
+        CHECK(d.view().get_data().back() == 205);
+    }
+    std::remove((prefix + ".snap").c_str());
+    std::remove((prefix + ".wal").c_str());
+}
+
+TEST_CASE("Durable container rejects a log newer than its snapshot") {
+    std::string prefix = "/tmp/mycontainer_durable_pair_" + std::to_string(::getpid());
+    std::remove((prefix + ".snap").c_str());
+    std::remove((prefix + ".wal").c_str());
+    std::string stale = prefix + ".stale";
+    {
+        DurableContainer<int> d(prefix, WalOptions(), 0);
+        d.add(1);
+        d.checkpoint();
+        d.view().save(stale); // an older snapshot than the next checkpoint
+        for (int i = 2; i <= 6; ++i)
+            d.add(i);
+        d.checkpoint();
+        d.add(7);
+    }
+    std::rename(stale.c_str(), (prefix + ".snap").c_str()); // as if the newest rename was lost
+    CHECK_THROWS_AS(DurableContainer<int>(prefix, WalOptions(), 0), std::runtime_error);
+    std::remove((prefix + ".snap").c_str());
+    CHECK_THROWS_AS(DurableContainer<int>(prefix, WalOptions(), 0), std::runtime_error);
+    std::remove((prefix + ".wal").c_str());
+}
+
+TEST_CASE("Write-ahead log failures are sticky and leave no torn tail") {
+    std::string path = "/tmp/mycontainer_wal_fail_" + std::to_string(::getpid()) + ".wal";
+    std::remove(path.c_str());
+    using Log = WriteAheadLog<int>;
+    const off_t good = 32 + 2 * static_cast<off_t>(1 + sizeof(int) + 4); // header and two records
+    auto file_size = [&]()
+    {
+        struct stat st;
+        return ::stat(path.c_str(), &st) == 0 ? st.st_size : off_t(-1);
+    };
+
+    // A file size limit just past the synced records makes the next write fail halfway.
+    struct rlimit saved;
+    REQUIRE(::getrlimit(RLIMIT_FSIZE, &saved) == 0);
+    struct rlimit tight = saved;
+    tight.rlim_cur = static_cast<rlim_t>(good) + 4;
+    auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+
+    for (bool flusher : {false, true}) {
+        CAPTURE(flusher);
+        std::remove(path.c_str());
+        WalOptions options;
+        options.group_delay = std::chrono::milliseconds(flusher ? 1 : 0);
+        {
+            Log log(path, options);
+            log.append(Log::Op::Add, 1);
+            log.append(Log::Op::Add, 2);
+            log.commit();
+            REQUIRE(::setrlimit(RLIMIT_FSIZE, &tight) == 0);
+            for (int i = 3; i <= 5; ++i)
+                log.append(Log::Op::Add, i);
+            if (flusher)
+                std::this_thread::sleep_for(std::chrono::milliseconds(100)); // the flusher's commit fails
+            else
+                CHECK_THROWS_AS(log.commit(), std::runtime_error);
+            REQUIRE(::setrlimit(RLIMIT_FSIZE, &saved) == 0);
+            CHECK(file_size() == good); // the torn record was truncated away
+            // The disk would accept the records now, but the failure stays latched.
+            CHECK_THROWS_AS(log.commit(), std::runtime_error);
+            CHECK_THROWS_AS(log.append(Log::Op::Add, 6), std::runtime_error);
+            CHECK_THROWS_AS(log.reset(0), std::runtime_error);
+        }
+        CHECK(file_size() == good);
+        Log reopened(path, WalOptions{64 * 1024, std::chrono::milliseconds(0)});
+        std::vector<int> replayed;
+        CHECK(reopened.replay([&](Log::Op, const int &value, uint64_t) { replayed.push_back(value); }) == 2);
+        CHECK(replayed == std::vector<int>{1, 2});
+        reopened.append(Log::Op::Add, 7);
+        CHECK_NOTHROW(reopened.commit());
+    }
+    std::remove(path.c_str());
+
+    // A durable container logs before mutating, so a failed log leaves it unchanged.
+    std::string prefix = "/tmp/mycontainer_durable_fail_" + std::to_string(::getpid());
+    std::remove((prefix + ".snap").c_str());
+    std::remove((prefix + ".wal").c_str());
+    {
+        DurableContainer<int> d(prefix, WalOptions{1, std::chrono::milliseconds(0)}, 0); // every append commits
+        d.add(1);
+        d.add(2);
+        REQUIRE(::setrlimit(RLIMIT_FSIZE, &tight) == 0);
+        CHECK_THROWS_AS(d.remove(1), std::runtime_error);
+        REQUIRE(::setrlimit(RLIMIT_FSIZE, &saved) == 0);
+        CHECK(d.view().contains(1));
+        CHECK_THROWS_AS(d.add(3), std::runtime_error);
+        CHECK(d.size() == 2);
+    }
+    {
+        DurableContainer<int> d(prefix, WalOptions(), 0);
+        CHECK(d.size() == 2);
+        CHECK(d.view().contains(1));
+    }
+    std::signal(SIGXFSZ, old_handler);
+    std::remove((prefix + ".snap").c_str());
+    std::remove((prefix + ".wal").c_str());
+}
+
+TEST_CASE("Background snapshot is written by a forked child") {
+    std::string path = "/tmp/mycontainer_bg_" + std::to_string(::getpid()) + ".snap";
+    MyContainer<int> c;
+    for (int i = 0; i < 1000; ++i)
+        c.add(i);
+    std::vector<int> frozen = c.get_data();
+
+    auto job = c.background_snapshot(path);
+    c.add(-1); // the parent keeps mutating; the child's view is frozen at the fork
+    c.remove(0);
+    CHECK(job.wait());
+    CHECK(job.status() == SnapshotJob::Status::Succeeded);
+    CHECK(job.target() == path);
+    CHECK(MyContainer<int>::load(path).get_data() == frozen);
+
+    auto failed = c.background_snapshot("/nonexistent-dir/x.snap");
+    CHECK_FALSE(failed.wait());
+    CHECK(failed.status() == SnapshotJob::Status::Failed);
+    CHECK_THROWS_WITH(c.save("/nonexistent-dir/x.snap"),
+                      doctest::Contains("Failed to create snapshot /nonexistent-dir/x.snap.tmp: "));
+
+    // The child persists the permutation captured before the fork, while pool threads exist.
+    WorkStealingPool pool(2);
+    c.sorted_indices();
+    std::vector<int> sorted_frozen = c.get_data();
+    auto with_sorted = c.background_snapshot(path);
+    pool.parallel_for(1000, [](size_t, size_t) {}, 10);
+    CHECK(with_sorted.wait());
+    MyContainer<int> loaded = MyContainer<int>::load(path);
+    CHECK(loaded.sorted_cached());
+    CHECK(loaded.get_data() == sorted_frozen);
+    std::remove(path.c_str());
+}
+
+template <typename T>
+void check_sorted_orders(workloads::Distribution d, size_t n)
+{
+    std::vector<T> values = workloads::generate<T>(d, n, 42);
+    MyContainer<T> c;
+    c.add_all(values.begin(), values.end());
+
+    std::vector<T> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<T> descending(sorted.rbegin(), sorted.rend());
+    std::vector<T> side_cross;
+    for (size_t left = 0, right = n; left < right; ++left)
+    {
+        side_cross.push_back(sorted[left]);
+        if (left < --right)
+            side_cross.push_back(sorted[right]);
+    }
+
+    INFO(workloads::name(d));
+    check_iterator(c, sorted, "Ascending");
+    check_iterator(c, descending, "Descending");
+    check_iterator(c, side_cross, "SideCross");
+}
+
+TEST_CASE("Workload generator is deterministic and shapes its sequences") {
+    using workloads::Distribution;
+    CHECK(workloads::generate<int>(Distribution::Uniform, 100, 7) == workloads::generate<int>(Distribution::Uniform, 100, 7));
+    CHECK(workloads::generate<int>(Distribution::Uniform, 100, 7) != workloads::generate<int>(Distribution::Uniform, 100, 8));
+
+    auto sorted = workloads::generate<std::string>(Distribution::Sorted, 500, 3);
+    CHECK(std::is_sorted(sorted.begin(), sorted.end()));
+    auto reversed = workloads::generate<double>(Distribution::ReverseSorted, 500, 3);
+    CHECK(std::is_sorted(reversed.rbegin(), reversed.rend()));
+
+    auto few = workloads::generate<int>(Distribution::FewDistinct, 1000, 3);
+    CHECK(std::set<int>(few.begin(), few.end()).size() <= 16);
+    auto same = workloads::generate<int>(Distribution::AllDuplicate, 1000, 3);
+    CHECK(std::set<int>(same.begin(), same.end()).size() == 1);
+
+    auto zipf = workloads::generate<int>(Distribution::Zipfian, 10000, 3);
+    std::map<int, size_t> freq;
+    for (int v : zipf)
+        ++freq[v];
+    size_t top = 0;
+    for (const auto &kv : freq)
+        top = std::max(top, kv.second);
+    CHECK(top > 10000 / 20);
+}
+
+TEST_CASE("Sort-based orders match std::sort on every workload distribution") {
+    for (auto d : workloads::ALL)
+    {
+        for (size_t n : {0, 1, 2, 257})
+        {
+            check_sorted_orders<int>(d, n);
+            check_sorted_orders<double>(d, n);
+            check_sorted_orders<std::string>(d, n);
+        }
+    }
+}
+
+TEST_CASE("Runtime statistics count operations, sorts and cache use") {
+    REQUIRE(ContainerStats::enabled);
+    MyContainer<int> c;
+    c.add(3);
+    c.add(1);
+    std::vector<int> more = {2, 5, 4};
+    c.add_all(more.begin(), more.end());
+    c.remove(5);
+
+    for (int v : c.Ascending())
+        (void)v;
+    for (int v : c.SideCross())
+        (void)v;
+    for (int v : c.Regular())
+        (void)v;
+
+    ContainerStats s = c.stats();
+    CHECK(s.adds == 5);
+    CHECK(s.removes == 1);
+    CHECK(s.iterators(Order::Ascending) == 2);
+    CHECK(s.iterators(Order::SideCross) == 2);
+    CHECK(s.iterators(Order::Regular) == 2);
+    CHECK(s.iterators(Order::Descending) == 0);
+    CHECK(s.sorts == 1);
+    CHECK(s.sort_cache_misses == 1);
+    CHECK(s.sort_cache_hits == 2); // Ascending end, SideCross build (its end reuses the cached sequence)
+    CHECK(s.bytes_allocated > 0);
+
+    auto it = c.Regular().begin();
+    c.add(9);
+    CHECK_THROWS(*it);
+    CHECK(c.stats().modification_errors == 1);
+
+    MyContainer<int> copy = c;
+    CHECK(copy.stats().adds == 0);
+
+    c.reset_stats();
+    CHECK(c.stats().adds == 0);
+    CHECK(c.stats().iterators(Order::Regular) == 0);
+}
+
+TEST_CASE("Trace events are written as Chrome trace JSON") {
+    std::string path = "/tmp/mycontainer_trace_" + std::to_string(getpid()) + ".json";
+    trace::start(path);
+    MyContainer<int> c;
+    std::vector<int> values = {5, 3, 8, 1};
+    c.add_all(values.begin(), values.end());
+    for (int v : c.Ascending())
+        (void)v;
+    c.remove(3);
+    trace::stop();
+    CHECK(trace::Recorder::instance().size() == 5); // add_all, sort, two iterators, remove
+    REQUIRE(trace::flush());
+
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    CHECK(json.find("\"traceEvents\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"sort\", \"cat\": \"sort\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"AscendingOrder::Iterator\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"add_all\", \"cat\": \"mutation\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"remove\", \"cat\": \"compaction\"") != std::string::npos);
+    CHECK(json.find("\"dropped_events\": 0") != std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Trace buffer keeps only the most recent events") {
+    std::string path = "/tmp/mycontainer_trace_ring_" + std::to_string(getpid()) + ".json";
+    trace::start(path, 3);
+    CHECK(trace::Recorder::instance().capacity() == 3);
+    MyContainer<int> c;
+    std::vector<int> values = {5, 3, 8, 1};
+    c.add_all(values.begin(), values.end()); // add_all
+    for (int v : c.Ascending())              // sort, two iterators
+        (void)v;
+    c.remove(3);                             // remove
+    trace::stop();
+    CHECK(trace::Recorder::instance().size() == 3);
+    CHECK(trace::Recorder::instance().dropped() == 2);
+    REQUIRE(trace::flush());
+
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    CHECK(json.find("\"name\": \"add_all\"") == std::string::npos);
+    CHECK(json.find("\"name\": \"sort\"") == std::string::npos);
+    size_t iterator = json.find("\"name\": \"AscendingOrder::Iterator\"");
+    size_t removal = json.find("\"name\": \"remove\"");
+    REQUIRE(iterator != std::string::npos);
+    REQUIRE(removal != std::string::npos);
+    CHECK(iterator < removal); // written oldest first
+    CHECK(json.find("\"dropped_events\": 2") != std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Metrics registry aggregates containers by name and renders Prometheus text") {
+    metrics::Registry registry;
+    MyContainer<int> a, b, other;
+    a.set_metrics_name("orders", registry);
+    b.set_metrics_name("orders", registry);
+    other.set_metrics_name("users", registry);
+
+    a.add(2);
+    a.add(1);
+    b.add(7);
+    other.add(4);
+    for (int v : a.Ascending())
+        (void)v;
+    b.remove(7);
+
+    ContainerStats orders = registry.stats("orders");
+    CHECK(orders.adds == 3);
+    CHECK(orders.removes == 1);
+    CHECK(orders.sorts == 1);
+    CHECK(orders.iterators(Order::Ascending) == 2);
+    CHECK(registry.stats("users").adds == 1);
+    CHECK(registry.stats("missing").adds == 0);
+
+    std::string text = registry.render();
+    CHECK(text.find("# TYPE mycontainer_adds_total counter") != std::string::npos);
+    CHECK(text.find("mycontainer_adds_total{container=\"orders\"} 3") != std::string::npos);
+    CHECK(text.find("mycontainer_adds_total{container=\"users\"} 1") != std::string::npos);
+    CHECK(text.find("mycontainer_iterators_total{container=\"orders\",order=\"Ascending\"} 2") != std::string::npos);
+    CHECK(text.find("# TYPE mycontainer_sort_seconds histogram") != std::string::npos);
+    CHECK(text.find("mycontainer_sort_seconds_count{container=\"orders\"} 1") != std::string::npos);
+    CHECK(text.find("mycontainer_iterator_build_seconds_bucket{container=\"orders\",order=\"Ascending\",le=\"+Inf\"} 2") != std::string::npos);
+
+    std::string path = "/tmp/mycontainer_metrics_" + std::to_string(getpid()) + ".prom";
+    registry.write(path);
+    std::ifstream in(path);
+    std::string written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    CHECK(written == registry.render());
+    std::remove(path.c_str());
+}
+
+template <typename T>
+long long sum_order(const MyContainer<T> &c, Order order)
+{
+    long long sum = 0;
+    switch (order)
+    {
+    case Order::Ascending:
+        for (const T &v : c.Ascending())
+            sum += v;
+        break;
+    case Order::Descending:
+        for (const T &v : c.Descending())
+            sum += v;
+        break;
+    case Order::SideCross:
+        for (const T &v : c.SideCross())
+            sum += v;
+        break;
+    case Order::Reverse:
+        for (const T &v : c.Reverse())
+            sum += v;
+        break;
+    case Order::Regular:
+        for (const T &v : c.Regular())
+            sum += v;
+        break;
+    case Order::MiddleOut:
+        for (const T &v : c.MiddleOut())
+            sum += v;
+        break;
+    }
+    return sum;
+}
+
+TEST_CASE("Iterating an unchanged container does not allocate") {
+    std::vector<int> values = workloads::generate<int>(workloads::Distribution::Uniform, 1000, 5);
+    MyContainer<int> c;
+    c.add_all(values.begin(), values.end());
+    const Order orders[] = {Order::Ascending, Order::Descending, Order::SideCross,
+                            Order::Reverse, Order::Regular, Order::MiddleOut};
+    for (Order order : orders)
+    {
+        long long expected = sum_order(c, order); // first pass builds and caches the permutation
+        alloc_counter::Scope scope;
+        long long sum = 0;
+        for (int rep = 0; rep < 10; ++rep)
+            sum += sum_order(c, order);
+        size_t allocations = scope.count();
+        CHECK(allocations == 0);
+        CHECK(sum == 10 * expected);
+    }
+}
+
+TEST_CASE("Repeated contains does not allocate on any lookup path") {
+    std::vector<int> values = workloads::generate<int>(workloads::Distribution::Uniform, 1000, 6);
+    MyContainer<int> c;
+    c.add_all(values.begin(), values.end());
+
+    auto probe = [&]()
+    {
+        alloc_counter::Scope scope;
+        size_t hits = 0;
+        for (size_t i = 0; i < 200; ++i)
+            hits += c.contains(values[i * 5]) ? 1 : 0;
+        hits += c.contains(-1) ? 1 : 0;
+        size_t allocations = scope.count();
+        CHECK(allocations == 0);
+        CHECK(hits == 200);
+    };
+    probe(); // linear scan
+    c.sorted_indices();
+    probe(); // binary search over the cached permutation
+    c.add(-2);
+    c.remove(-2);
+    probe(); // hash lookup
+
+    // The search indexes are built lazily: the first lookup allocates, the next ones do not.
+    MyContainer<int> indexed;
+    indexed.add_all(values.begin(), values.end());
+    indexed.sorted_indices();
+    indexed.use_search_index(true);
+    {
+        alloc_counter::Scope building;
+        CHECK(indexed.contains(values[0]));
+        CHECK(building.count() > 0);
+    }
+    alloc_counter::Scope steady;
+    for (size_t i = 0; i < 200; ++i)
+        CHECK(indexed.contains(values[i * 5]));
+    CHECK(steady.count() == 0);
+}
+
+TEST_CASE("Steady-state add after reserve does not allocate") {
+    MyContainer<int> c;
+    c.add(1);
+    {
+        alloc_counter::Scope reserving;
+        c.reserve(10001);
+        CHECK(reserving.count() == 1); // the counter is live: the new buffer is seen
+    }
+    alloc_counter::Scope scope;
+    for (int i = 0; i < 10000; ++i)
+        c.add(i);
+    size_t allocations = scope.count();
+    CHECK(allocations == 0);
+    CHECK(c.size() == 10001);
+}
+
+template <typename Range>
+size_t walk(const Range &range)
+{
+    size_t visited = 0;
+    for (auto it = range.begin(); it != range.end(); ++it)
+    {
+        (void)*it;
+        ++visited;
+    }
+    return visited;
+}
+
+TEST_CASE("Orders and mutations stay within their comparison and copy bounds") {
+    for (size_t n : {100, 1000, 10000})
+    {
+        INFO("n = " << n);
+        size_t lg = 1;
+        while ((size_t(1) << lg) < n)
+            ++lg;
+        std::vector<int> keys = workloads::generate<int>(workloads::Distribution::Uniform, n, 11);
+        std::vector<Instrumented> values(keys.begin(), keys.end());
+
+        MyContainer<Instrumented> c;
+        Instrumented::reset();
+        for (const auto &v : values)
+            c.add(v);
+        CHECK(Instrumented::counts.copies == n);
+        CHECK(Instrumented::counts.moves <= 2 * n);
+        CHECK(Instrumented::counts.less == 0);
+        CHECK(Instrumented::counts.equal == 0);
+        CHECK(Instrumented::counts.hashes == 0);
+
+        // Insertion-order traversals never compare.
+        Instrumented::reset();
+        CHECK(walk(c.Regular()) == n);
+        CHECK(walk(c.Reverse()) == n);
+        CHECK(walk(c.MiddleOut()) == n);
+        CHECK(Instrumented::counts.less == 0);
+        CHECK(Instrumented::counts.equal == 0);
+
+        // The first sorted traversal sorts indices once: O(n log n) comparisons, no element copies.
+        Instrumented::reset();
+        CHECK(walk(c.Ascending()) == n);
+        CHECK(Instrumented::counts.less <= 3 * n * lg);
+        CHECK(Instrumented::counts.copies == 0);
+        CHECK(Instrumented::counts.moves == 0);
+
+        // Every later sorted traversal reuses the cached permutation.
+        Instrumented::reset();
+        CHECK(walk(c.Ascending()) == n);
+        CHECK(walk(c.Descending()) == n);
+        CHECK(walk(c.SideCross()) == n);
+        CHECK(Instrumented::counts.less == 0);
+        CHECK(Instrumented::counts.copies == 0);
+
+        // contains() binary-searches the cached permutation.
+        Instrumented::reset();
+        for (size_t i = 0; i < 10; ++i)
+            CHECK(c.contains(values[i * (n / 10)]));
+        CHECK(Instrumented::counts.less <= 10 * (lg + 2));
+        CHECK(Instrumented::counts.equal == 0);
+
+        // Copies are O(1); the first write to a copy deep-copies once.
+        Instrumented::reset();
+        MyContainer<Instrumented> copy = c;
+        CHECK(Instrumented::counts.copies == 0);
+        copy.add(Instrumented(-1));
+        CHECK(Instrumented::counts.copies <= n + 1);
+        CHECK(Instrumented::counts.less == 0);
+
+        // The first remove builds the hash lookup (linear) and compacts once.
+        Instrumented::reset();
+        c.remove(values[0]);
+        CHECK(Instrumented::counts.hashes <= 2 * n + 4);
+        CHECK(Instrumented::counts.equal <= 3 * n);
+        CHECK(Instrumented::counts.copies <= n);
+        CHECK(Instrumented::counts.moves <= n);
+        CHECK(Instrumented::counts.less == 0);
+
+        // Later removes hash a constant number of times; the compaction stays linear.
+        Instrumented::reset();
+        c.remove(values[1]);
+        CHECK(Instrumented::counts.hashes <= 8);
+        CHECK(Instrumented::counts.equal <= n + 64);
+        CHECK(Instrumented::counts.moves <= n);
+        CHECK(Instrumented::counts.copies == 0);
+        CHECK(Instrumented::counts.less == 0);
+
+        // Bulk insertion copies each new element once.
+        Instrumented::reset();
+        c.add_all(values.begin(), values.begin() + n / 2);
+        CHECK(Instrumented::counts.copies <= 2 * (n / 2));
+        CHECK(Instrumented::counts.moves <= 2 * n);
+        CHECK(Instrumented::counts.less == 0);
+    }
+}
+
+template <typename T>
+void check_order_statistics(const MyContainer<T> &c, std::vector<T> sorted)
+{
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    for (size_t k : {size_t(0), n / 3, n / 2, n - 1})
+        CHECK(c.nth(k) == sorted[k]);
+    CHECK(c.median() == sorted[(n - 1) / 2]);
+    CHECK(c.percentile(0) == sorted.front());
+    CHECK(c.percentile(100) == sorted.back());
+    CHECK(c.percentile(50) == sorted[(n + 1) / 2 - 1]);
+    CHECK(c.percentile(99) == sorted[static_cast<size_t>(std::ceil(0.99 * n)) - 1]);
+    for (size_t i : {size_t(0), n / 4, n / 2, n - 1})
+    {
+        const T &v = sorted[i];
+        CHECK(c.rank(v) == static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), v) - sorted.begin()));
+    }
+}
+
+TEST_CASE("Order statistics select without sorting and reuse a cached permutation") {
+    for (auto d : workloads::ALL)
+    {
+        INFO(workloads::name(d));
+        auto ints = workloads::generate<int>(d, 501, 21);
+        MyContainer<int> c;
+        c.add_all(ints.begin(), ints.end());
+        check_order_statistics(c, ints);
+        CHECK_FALSE(c.sorted_cached()); // selection and counting never sort
+        c.sorted_indices();
+        check_order_statistics(c, ints);
+
+        auto strings = workloads::generate<std::string>(d, 200, 21);
+        MyContainer<std::string> s;
+        s.add_all(strings.begin(), strings.end());
+        check_order_statistics(s, strings);
+        CHECK_FALSE(s.sorted_cached());
+    }
+
+    std::vector<int> keys = workloads::generate<int>(workloads::Distribution::Uniform, 4096, 5);
+    MyContainer<Instrumented> instrumented;
+    instrumented.add_all(keys.begin(), keys.end());
+    instrumented.sorted_indices();
+    Instrumented::reset();
+    instrumented.rank(keys[7]);
+    instrumented.median();
+    CHECK(Instrumented::counts.less <= 13); // log2(4096) + 1 comparisons, nth is a lookup
+
+    MyContainer<int> c;
+    CHECK_THROWS_AS(c.nth(0), std::out_of_range);
+    CHECK_THROWS_AS(c.median(), std::runtime_error);
+    CHECK(c.rank(5) == 0);
+    c.add(3);
+    CHECK_THROWS_AS(c.percentile(101), std::invalid_argument);
+    CHECK(c.median() == 3);
+}
+
+template <typename It>
+std::vector<int> collect(It first, const It &last)
+{
+    std::vector<int> out;
+    for (; first != last; ++first)
+        out.push_back(*first);
+    return out;
+}
+
+TEST_CASE("Ascending range queries binary-search the sorted permutation") {
+    for (auto d : workloads::ALL)
+    {
+        INFO(workloads::name(d));
+        auto values = workloads::generate<int>(d, 777, 9);
+        MyContainer<int> c;
+        c.add_all(values.begin(), values.end());
+        std::vector<int> sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+        auto asc = c.Ascending();
+
+        auto bumped = [](int v) // v + 1 without overflowing at INT_MAX (workload keys span 31 bits)
+        { return static_cast<int>(std::min<int64_t>(int64_t(v) + 1, std::numeric_limits<int>::max())); };
+        for (int probe : {sorted.front() - 1, sorted.front(), sorted[300], bumped(sorted[300]), sorted.back(), bumped(sorted.back())})
+        {
+            auto lb = std::lower_bound(sorted.begin(), sorted.end(), probe);
+            auto ub = std::upper_bound(sorted.begin(), sorted.end(), probe);
+            CHECK(collect(asc.lower_bound(probe), asc.end()) == std::vector<int>(lb, sorted.end()));
+            CHECK(collect(asc.upper_bound(probe), asc.end()) == std::vector<int>(ub, sorted.end()));
+
+            int nearest = *asc.nearest(probe);
+            int best = sorted.front();
+            for (int x : sorted)
+                if (std::abs(static_cast<long>(x) - probe) < std::abs(static_cast<long>(best) - probe))
+                    best = x;
+            CHECK(nearest == best);
+        }
+
+        int lo = sorted[100], hi = sorted[600];
+        auto range = asc.between(lo, hi);
+        std::vector<int> expected;
+        std::copy_if(sorted.begin(), sorted.end(), std::back_inserter(expected), [&](int x)
+                     { return lo <= x && x <= hi; });
+        CHECK(range.size() == expected.size());
+        CHECK(collect(range.begin(), range.end()) == expected);
+        if (hi < std::numeric_limits<int>::max())
+            CHECK(asc.between(hi + 1, hi).empty());
+        CHECK(c.stats().sorts == 1);
+    }
+
+    std::vector<int> keys = workloads::generate<int>(workloads::Distribution::Uniform, 4096, 3);
+    MyContainer<Instrumented> instrumented;
+    instrumented.add_all(keys.begin(), keys.end());
+    instrumented.sorted_indices();
+    Instrumented::reset();
+    auto range = instrumented.Ascending().between(Instrumented(1000), Instrumented(1 << 30));
+    CHECK(Instrumented::counts.less <= 2 * 13 + 1); // two binary searches, no scan
+
+    MyContainer<int> c;
+    CHECK(c.Ascending().nearest(5) == c.Ascending().end());
+    CHECK(c.Ascending().between(0, 10).empty());
+    c.add(1);
+    c.add(4);
+    CHECK(*c.Ascending().nearest(2) == 1);
+    CHECK(*c.Ascending().nearest(3) == 4);
+    CHECK(*c.Ascending().nearest(std::numeric_limits<int>::min()) == 1);
+    auto it = c.Ascending().lower_bound(2);
+    c.add(3);
+    CHECK_THROWS_AS(*it, std::runtime_error);
+}
+
+TEST_CASE("Eytzinger search index matches binary search and is rebuilt per version") {
+    for (auto d : workloads::ALL)
+    {
+        INFO(workloads::name(d));
+        for (size_t n : {size_t(1), size_t(2), size_t(7), size_t(64), size_t(1000)})
+        {
+            auto values = workloads::generate<int>(d, n, 17);
+            MyContainer<int> plain;
+            plain.add_all(values.begin(), values.end());
+            MyContainer<int> indexed = plain;
+            indexed.use_search_index();
+            plain.sorted_indices();
+
+            std::vector<int> probes(values.begin(), values.begin() + std::min<size_t>(n, 50));
+            probes.push_back(-1);
+            probes.push_back(std::numeric_limits<int>::max());
+            for (int p : probes)
+            {
+                // Neighbouring probes are computed in 64 bits and clamped, so INT_MAX does not overflow.
+                int next = static_cast<int>(std::min<int64_t>(int64_t(p) + 1, std::numeric_limits<int>::max()));
+                int far = static_cast<int>(std::min<int64_t>(int64_t(p) + 1000, std::numeric_limits<int>::max()));
+                CHECK(collect(indexed.Ascending().lower_bound(p), indexed.Ascending().end()) ==
+                      collect(plain.Ascending().lower_bound(p), plain.Ascending().end()));
+                CHECK(collect(indexed.Ascending().upper_bound(p), indexed.Ascending().end()) ==
+                      collect(plain.Ascending().upper_bound(p), plain.Ascending().end()));
+                CHECK(indexed.rank(p) == plain.rank(p));
+                CHECK(indexed.contains(next) == plain.contains(next));
+                CHECK(*indexed.Ascending().nearest(p) == *plain.Ascending().nearest(p));
+                CHECK(indexed.Ascending().between(p, far).size() == plain.Ascending().between(p, far).size());
+            }
+        }
+    }
+
+    MyContainer<int> c;
+    c.use_search_index();
+    for (int i = 0; i < 100; i += 2)
+        c.add(i);
+    CHECK(c.Ascending().between(10, 20).size() == 6);
+    c.add(15);
+    CHECK(c.Ascending().between(10, 20).size() == 7); // the mutation dropped the stale index
+    CHECK(c.rank(16) == 9);
+
+    std::vector<int> keys = workloads::generate<int>(workloads::Distribution::Uniform, 4095, 8);
+    MyContainer<Instrumented> instrumented;
+    instrumented.add_all(keys.begin(), keys.end());
+    instrumented.use_search_index();
+    instrumented.Ascending().lower_bound(Instrumented(0)); // builds the index
+    Instrumented::reset();
+    instrumented.Ascending().lower_bound(Instrumented(keys[5]));
+    CHECK(Instrumented::counts.less == 12); // one comparison per level of the complete tree
+}
+
+TEST_CASE("Learned index predicts sorted positions within its error bound") {
+    for (auto d : workloads::ALL)
+    {
+        INFO(workloads::name(d));
+        for (size_t epsilon : {size_t(1), size_t(8), size_t(64)})
+        {
+            auto keys = workloads::generate<int>(d, 2000, 31);
+            std::vector<int64_t> values(keys.begin(), keys.end());
+            MyContainer<int64_t> plain;
+            plain.add_all(values.begin(), values.end());
+            MyContainer<int64_t> learned = plain;
+            learned.use_learned_index(epsilon);
+            plain.sorted_indices();
+
+            std::vector<int64_t> probes(values.begin(), values.begin() + 100);
+            for (int64_t p : std::vector<int64_t>(probes))
+                probes.push_back(p + 1);
+            probes.push_back(std::numeric_limits<int64_t>::min());
+            probes.push_back(std::numeric_limits<int64_t>::max());
+            for (int64_t p : probes)
+            {
+                CHECK(learned.rank(p) == plain.rank(p));
+                CHECK(learned.contains(p) == plain.contains(p));
+                CHECK(collect(learned.Ascending().upper_bound(p), learned.Ascending().end()).size() ==
+                      collect(plain.Ascending().upper_bound(p), plain.Ascending().end()).size());
+            }
+        }
+    }
+
+    std::vector<int64_t> timestamps;
+    for (int64_t i = 0; i < 100000; ++i)
+        timestamps.push_back(1700000000000 + i * 250 + (i % 7));
+    MyContainer<int64_t> c;
+    c.add_all(timestamps.begin(), timestamps.end());
+    c.use_learned_index(16);
+    CHECK(c.Ascending().between(1700000000000 + 250 * 100, 1700000000000 + 250 * 199 + 6).size() == 100);
+    CHECK(c.rank(1700000000000 + 250 * 5000) == 5000);
+
+    LearnedIndex<int64_t> model(c.get_data(), *c.sorted_indices(), 16);
+    CHECK(model.segments() == 1); // a regular series is a single line
+    CHECK(model.memory_bytes() < 100);
+
+    c.add(1700000000000 + 125);
+    CHECK(c.rank(1700000000000 + 250) == 2); // refitted after the mutation
+
+    std::vector<int64_t> steps;
+    for (int64_t i = 0; i < 1000; ++i)
+        steps.push_back(i < 500 ? i : 1000000 + i * i);
+    MyContainer<int64_t> piecewise;
+    piecewise.add_all(steps.begin(), steps.end());
+    const auto &data = piecewise.get_data();
+    auto sorted = piecewise.sorted_indices();
+    LearnedIndex<int64_t> fitted(data, *sorted, 4);
+    CHECK(fitted.segments() > 1);
+    for (size_t i = 0; i < steps.size(); ++i)
+        CHECK(fitted.lower_bound(data, *sorted, steps[i]) == i);
+}